@@ -36,6 +36,7 @@
 #ifndef BASE_HFL110DCU_H_
 #define BASE_HFL110DCU_H_
 #include <hfl_interface.h>
+#include <range_table.h>
 #include <string>
 #include <vector>
 
@@ -151,6 +152,15 @@ public:
   ///
   bool setExtrinsicTranslatationZ(double z);
 
+  ///
+  /// Sets time offset residual
+  ///
+  /// @param[in] offset seconds added to synchronized stamps
+  ///
+  /// @return bool true if given time offset is set
+  ///
+  bool setTimeOffset(double offset);
+
   ///
   /// Sets extrinsics_reconfigured flag
   ///
@@ -195,7 +205,7 @@ protected:
   ///
   /// @return bool true if successfully parsed object data
   ///
-  virtual bool parseObjects(int start_byte, const std::vector<uint8_t>& packet) = 0;
+  virtual bool parseObjects(int start_byte, PacketView packet) = 0;
 
   ///
   /// Process the object data from udp packets
@@ -204,7 +214,7 @@ protected:
   ///
   /// @return bool
   ///
-  virtual bool processObjectData(const std::vector<uint8_t>& data) = 0;
+  virtual bool processObjectData(PacketView data) = 0;
 
   ///
   /// Process the telemetry data from udp packets
@@ -213,7 +223,7 @@ protected:
   ///
   /// @return bool
   ///
-  virtual bool processTelemetryData(const std::vector<uint8_t>& data) = 0;
+  virtual bool processTelemetryData(PacketView data) = 0;
 
   ///
   /// Process the slice data from udp packets
@@ -222,7 +232,11 @@ protected:
   ///
   /// @return bool
   ///
-  virtual bool processSliceData(const std::vector<uint8_t>& data) = 0;
+  virtual bool processSliceData(PacketView data) = 0;
+
+protected:
+  /// Raw range conversion, rebuilt when the global range offset changes
+  RangeTable range_table_;
 };
 }  // namespace hfl
 
@@ -0,0 +1,216 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// @file bounded_queue.h
+///
+/// @brief This file defines the bounded hand-off queue between threads.
+///
+#ifndef BOUNDED_QUEUE_H_
+#define BOUNDED_QUEUE_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+namespace hfl
+{
+/// What a full queue drops to accept a new item
+enum overflow_policy
+{
+  overflow_drop_oldest = 0,
+  overflow_drop_newest
+};
+
+///
+/// @brief Bounded multi-producer/multi-consumer queue that never blocks producers.
+///
+/// A full queue drops either its oldest item, so consumers always get the
+/// latest data, or the new item, so nothing queued is lost. Consumers wait
+/// for items until the queue is closed.
+///
+/// @tparam T item type, moved in and out
+///
+template <typename T>
+class BoundedQueue
+{
+public:
+  ///
+  /// BoundedQueue constructor
+  ///
+  /// @param capacity maximum number of queued items, at least 1
+  /// @param policy item dropped when full
+  ///
+  BoundedQueue(size_t capacity, overflow_policy policy)
+    : capacity_(capacity > 0 ? capacity : 1), policy_(policy), closed_(false), drop_count_(0), max_depth_(0)
+  {
+  }
+
+  BoundedQueue(const BoundedQueue&) = delete;
+  BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+  ///
+  /// Adds an item, drops one according to the policy if the queue is full
+  ///
+  /// @param[in] item item to queue
+  ///
+  /// @return bool false if an item was dropped
+  ///
+  bool push(T item)
+  {
+    bool dropped = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (items_.size() >= capacity_)
+      {
+        drop_count_ += 1;
+        dropped = true;
+        if (policy_ == overflow_drop_newest)
+        {
+          return false;
+        }
+        items_.pop_front();
+      }
+      items_.push_back(std::move(item));
+      if (items_.size() > max_depth_)
+      {
+        max_depth_ = items_.size();
+      }
+    }
+    ready_.notify_one();
+    return !dropped;
+  }
+
+  ///
+  /// Takes the oldest item, waits until there is one or the queue is closed
+  ///
+  /// @param[out] item oldest item
+  ///
+  /// @return bool false if the queue was closed and is empty
+  ///
+  bool pop(T& item)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    ready_.wait(lock, [this] { return !items_.empty() || closed_; });
+    if (items_.empty())
+    {
+      return false;
+    }
+    item = std::move(items_.front());
+    items_.pop_front();
+    return true;
+  }
+
+  ///
+  /// Wakes all consumers, they drain the remaining items and then stop
+  ///
+  void close()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_ = true;
+    }
+    ready_.notify_all();
+  }
+
+  ///
+  /// Returns the number of queued items
+  ///
+  /// @return size_t queue depth
+  ///
+  size_t depth() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return items_.size();
+  }
+
+  ///
+  /// Returns the highest queue depth seen so far
+  ///
+  /// @return size_t maximum queue depth
+  ///
+  size_t getMaxDepth() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return max_depth_;
+  }
+
+  ///
+  /// Returns the number of items dropped because the queue was full
+  ///
+  /// @return uint64_t drop count
+  ///
+  uint64_t getDropCount() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return drop_count_;
+  }
+
+  ///
+  /// Returns the queue capacity
+  ///
+  /// @return size_t maximum number of queued items
+  ///
+  size_t capacity() const
+  {
+    return capacity_;
+  }
+
+private:
+  /// Maximum number of queued items
+  size_t capacity_;
+
+  /// Item dropped when full
+  overflow_policy policy_;
+
+  /// Guards all members below
+  mutable std::mutex mutex_;
+
+  /// Signals new items and closing
+  std::condition_variable ready_;
+
+  /// Queued items, oldest first
+  std::deque<T> items_;
+
+  /// Consumers stop once empty
+  bool closed_;
+
+  /// Dropped item counter
+  uint64_t drop_count_;
+
+  /// Maximum queue depth
+  size_t max_depth_;
+};
+
+}  // namespace hfl
+#endif  // BOUNDED_QUEUE_H_
@@ -0,0 +1,109 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// @file calibration_monitor.h
+///
+/// @brief This file defines the sensor calibration change detector.
+///
+#ifndef CALIBRATION_MONITOR_H_
+#define CALIBRATION_MONITOR_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace hfl
+{
+///
+/// @brief Detects changes of the calibration block sent with every frame.
+///
+/// Keeps a 64 bit FNV-1a hash of the last block, so unchanged calibration
+/// costs one hash per frame instead of parsing every parameter and
+/// rebuilding camera info, transform and rays. Each change starts a new
+/// calibration epoch.
+///
+class CalibrationMonitor
+{
+public:
+  ///
+  /// CalibrationMonitor constructor, the first block is always a change
+  ///
+  CalibrationMonitor();
+
+  ///
+  /// Checks a calibration block
+  ///
+  /// @param[in] data calibration block, no alignment required
+  /// @param[in] size block size in bytes
+  ///
+  /// @return bool true if this is the first block or it differs from the last
+  ///
+  bool update(const uint8_t* data, size_t size);
+
+  ///
+  /// Returns the hash of the last block
+  ///
+  /// @return uint64_t hash, 0 before the first block
+  ///
+  uint64_t getHash() const
+  {
+    return hash_;
+  }
+
+  ///
+  /// Returns the number of calibrations seen
+  ///
+  /// @return uint32_t epoch, 0 before the first block
+  ///
+  uint32_t getEpoch() const
+  {
+    return epoch_;
+  }
+
+  ///
+  /// Hashes a block with 64 bit FNV-1a
+  ///
+  /// @param[in] data first byte
+  /// @param[in] size size in bytes
+  ///
+  /// @return uint64_t hash
+  ///
+  static uint64_t hash(const uint8_t* data, size_t size);
+
+private:
+  /// Hash of the last block
+  uint64_t hash_;
+
+  /// Number of changes seen
+  uint32_t epoch_;
+};
+
+}  // namespace hfl
+#endif  // CALIBRATION_MONITOR_H_
@@ -0,0 +1,195 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// @file clock_sync.h
+///
+/// @brief This file defines the sensor to host clock synchronization class.
+///
+#ifndef CLOCK_SYNC_H_
+#define CLOCK_SYNC_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+namespace hfl
+{
+/// Default sensor clock resolution in seconds per tick
+const double CLOCK_SYNC_TICK{ 1e-6 };
+/// Default number of minimum-delay buckets used in the regression
+const size_t CLOCK_SYNC_WINDOW{ 32 };
+/// Default host time in seconds covered by one minimum-delay bucket
+const double CLOCK_SYNC_BUCKET{ 1.0 };
+/// Offset jump in seconds that restarts the estimation (sensor reboot)
+const double CLOCK_SYNC_RESET{ 1.0 };
+
+///
+/// @brief Maps sensor timestamps to host time.
+///
+/// Every sample pairs a sensor timestamp with the host receive time, so
+/// its offset (host - sensor) is the true clock offset plus a positive
+/// transport delay. The smallest offset of each bucket is the sample with
+/// the least delay; a linear regression over the bucket minima estimates
+/// offset and drift of the sensor clock.
+///
+class ClockSync
+{
+public:
+  ///
+  /// ClockSync constructor
+  ///
+  /// @param tick sensor clock resolution in seconds per tick
+  /// @param window number of minimum-delay buckets in the regression
+  /// @param bucket host time in seconds covered by one bucket
+  ///
+  ClockSync(double tick = CLOCK_SYNC_TICK, size_t window = CLOCK_SYNC_WINDOW,
+            double bucket = CLOCK_SYNC_BUCKET);
+
+  ///
+  /// Adds a timestamp pair
+  ///
+  /// @param[in] sensor_ticks sensor timestamp in ticks
+  /// @param[in] host_time host receive time in seconds
+  ///
+  void addSample(uint64_t sensor_ticks, double host_time);
+
+  ///
+  /// Converts a sensor timestamp to host time
+  ///
+  /// @param[in] sensor_ticks sensor timestamp in ticks
+  ///
+  /// @return double host time in seconds, 0 if no sample was added yet
+  ///
+  double toHost(uint64_t sensor_ticks) const;
+
+  ///
+  /// Drops all samples
+  ///
+  void reset();
+
+  ///
+  /// Returns true once a sample was added
+  ///
+  /// @return bool true if toHost can be used
+  ///
+  bool isValid() const
+  {
+    return started_;
+  }
+
+  ///
+  /// Returns the estimated clock offset at the latest sample
+  ///
+  /// @return double host - sensor time in seconds, minimum delay included
+  ///
+  double getOffset() const
+  {
+    return intercept_ + drift_ * latest_;
+  }
+
+  ///
+  /// Returns the estimated drift of the sensor clock
+  ///
+  /// @return double host seconds gained per sensor second
+  ///
+  double getDrift() const
+  {
+    return drift_;
+  }
+
+  ///
+  /// Returns the number of restarts caused by offset jumps
+  ///
+  /// @return uint64_t reset count
+  ///
+  uint64_t getResetCount() const
+  {
+    return reset_count_;
+  }
+
+private:
+  /// Sample relative to the sensor time origin
+  struct Sample
+  {
+    double sensor;
+    double offset;
+  };
+
+  /// Seconds per sensor tick
+  double tick_;
+
+  /// Number of buckets in the regression
+  size_t window_;
+
+  /// Host seconds per bucket
+  double bucket_duration_;
+
+  /// True once the first sample set the origin
+  bool started_;
+
+  /// Sensor ticks of the first sample
+  uint64_t origin_;
+
+  /// Host time the current bucket started
+  double bucket_start_;
+
+  /// Minimum offset sample of the current bucket
+  Sample bucket_min_;
+
+  /// Minima of the closed buckets, oldest first
+  std::deque<Sample> minima_;
+
+  /// Regression result, offset = intercept + drift * sensor
+  double intercept_;
+  double drift_;
+
+  /// Sensor time of the latest sample
+  double latest_;
+
+  /// Number of restarts
+  uint64_t reset_count_;
+
+  ///
+  /// Returns seconds since the sensor time origin
+  ///
+  /// @param[in] sensor_ticks sensor timestamp in ticks
+  ///
+  /// @return double sensor seconds
+  ///
+  double toSeconds(uint64_t sensor_ticks) const;
+
+  ///
+  /// Fits offset and drift to the bucket minima
+  ///
+  void fit();
+};
+
+}  // namespace hfl
+#endif  // CLOCK_SYNC_H_
@@ -0,0 +1,119 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// @file decoder_registry.h
+///
+/// @brief This file defines the packet decoder registry.
+///
+#ifndef DECODER_REGISTRY_H_
+#define DECODER_REGISTRY_H_
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace hfl
+{
+///
+/// @brief Maps camera model and firmware version to a packet decoder.
+///
+/// Decoders are looked up once when a camera is created, the packet path
+/// then dispatches through the resolved decoder without any string work.
+/// Supporting a new firmware version means registering a new decoder.
+///
+/// @tparam Decoder decoder object or function table
+///
+template <typename Decoder>
+class DecoderRegistry
+{
+public:
+  ///
+  /// Registers a decoder, replacing one registered for the same version
+  ///
+  /// @param[in] model camera model
+  /// @param[in] version firmware version
+  /// @param[in] decoder decoder to register
+  ///
+  void add(const std::string& model, const std::string& version, const Decoder& decoder)
+  {
+    decoders_[std::make_pair(model, version)] = decoder;
+  }
+
+  ///
+  /// Looks up a decoder
+  ///
+  /// @param[in] model camera model
+  /// @param[in] version firmware version
+  /// @param[out] decoder registered decoder, unchanged if not found
+  ///
+  /// @return bool true if a decoder is registered
+  ///
+  bool find(const std::string& model, const std::string& version, Decoder& decoder) const
+  {
+    typename std::map<std::pair<std::string, std::string>, Decoder>::const_iterator it =
+      decoders_.find(std::make_pair(model, version));
+    if (it == decoders_.end())
+    {
+      return false;
+    }
+    decoder = it->second;
+    return true;
+  }
+
+  ///
+  /// Returns the registered versions of a model
+  ///
+  /// @param[in] model camera model
+  ///
+  /// @return std::vector<std::string> firmware versions
+  ///
+  std::vector<std::string> getVersions(const std::string& model) const
+  {
+    std::vector<std::string> versions;
+    for (const auto& entry : decoders_)
+    {
+      if (entry.first.first == model)
+      {
+        versions.push_back(entry.first.second);
+      }
+    }
+    return versions;
+  }
+
+private:
+  /// Decoders keyed by model and version
+  std::map<std::pair<std::string, std::string>, Decoder> decoders_;
+};
+
+}  // namespace hfl
+
+#endif  // DECODER_REGISTRY_H_
@@ -0,0 +1,113 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// @file depth_codec.h
+///
+/// @brief This file defines the lossless depth and intensity image codec.
+///
+#ifndef DEPTH_CODEC_H_
+#define DEPTH_CODEC_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hfl
+{
+/// Pixel formats of compressed images
+enum depth_codec_format
+{
+  /// 32 bit float ranges in meters, NaN for no return
+  depth_codec_range = 0,
+  /// 16 bit words, e.g. intensities
+  depth_codec_word
+};
+
+/// Size of the compressed image header in bytes
+const size_t DEPTH_CODEC_HEADER_SIZE{ 14 };
+/// Largest image the decoder accepts, so a corrupt header cannot request
+/// a huge allocation
+const uint64_t DEPTH_CODEC_MAX_PIXELS{ uint64_t(1) << 24 };
+
+///
+/// @brief Compresses depth and intensity images without loss.
+///
+/// Ranges are stored as the fixed point words the sensor sends (meters *
+/// 256), which every decoded range is unless the range offset is
+/// fractional. Each word is predicted from the pixel above, the first row
+/// from the pixel to its left, and the residuals are written as variable
+/// length integers with runs of zero residuals and of no returns collapsed
+/// into one token. Ranges that are not fixed point are stored verbatim, so
+/// decoding always gives back the exact bits that were encoded.
+///
+class DepthCodec
+{
+public:
+  ///
+  /// Compresses an image of ranges
+  ///
+  /// @param[in] ranges rows * columns ranges, row major
+  /// @param[in] rows number of rows
+  /// @param[in] columns number of columns
+  /// @param[out] out compressed image, replaces the contents
+  ///
+  static void encode(const float* ranges, uint32_t rows, uint32_t columns, std::vector<uint8_t>& out);
+
+  ///
+  /// Compresses an image of 16 bit words
+  ///
+  /// @param[in] words rows * columns words, row major
+  /// @param[in] rows number of rows
+  /// @param[in] columns number of columns
+  /// @param[out] out compressed image, replaces the contents
+  ///
+  static void encode(const uint16_t* words, uint32_t rows, uint32_t columns, std::vector<uint8_t>& out);
+
+  ///
+  /// Decompresses an image
+  ///
+  /// @param[in] data compressed image
+  /// @param[in] size size of the compressed image in bytes
+  /// @param[out] format pixel format of the image
+  /// @param[out] rows number of rows
+  /// @param[out] columns number of columns
+  /// @param[out] image rows * columns pixels, row major in host byte order
+  ///
+  /// @return bool true if successful, false if the data is malformed or the
+  /// image larger than DEPTH_CODEC_MAX_PIXELS
+  ///
+  static bool decode(const uint8_t* data, size_t size, depth_codec_format& format, uint32_t& rows,
+                     uint32_t& columns, std::vector<uint8_t>& image);
+};
+
+}  // namespace hfl
+
+#endif  // DEPTH_CODEC_H_
@@ -0,0 +1,214 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// @file frame_buffer.h
+///
+/// @brief This file defines the frame plane buffer class.
+///
+#ifndef FRAME_BUFFER_H_
+#define FRAME_BUFFER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace hfl
+{
+/// Frame buffer plane alignment in bytes, one cache line
+const size_t FRAME_BUFFER_ALIGNMENT{ 64 };
+
+/// Image planes of a frame
+enum frame_plane
+{
+  plane_depth = 0,
+  plane_depth2,
+  plane_intensity,
+  plane_intensity2,
+  plane_crosstalk,
+  plane_saturated,
+  plane_superimposed,
+  plane_crosstalk2,
+  plane_saturated2,
+  plane_superimposed2,
+  plane_count
+};
+
+///
+/// @brief Locates the image planes of one frame.
+///
+/// Depth planes are float meters, intensity planes uint16_t and flag
+/// planes uint8_t, each row major. The plane and row views are the
+/// contract; where the planes live depends on how the buffer is used.
+/// An allocating buffer holds all planes in one allocation, each starting
+/// on a cache line, reused for every frame. Planes can be bound to outside
+/// memory, e.g. the messages they are published in, and are then neither
+/// contiguous nor aligned. A buffer whose planes are always bound is
+/// created without an allocation.
+///
+class FrameBuffer
+{
+public:
+  ///
+  /// FrameBuffer constructor, throws std::bad_alloc if allocation fails
+  ///
+  /// @param rows number of rows per frame
+  /// @param columns number of columns per frame
+  /// @param allocate allocate the planes, otherwise planes are null until bound
+  ///
+  FrameBuffer(uint16_t rows, uint16_t columns, bool allocate = true);
+
+  ///
+  /// FrameBuffer destructor
+  ///
+  ~FrameBuffer();
+
+  FrameBuffer(const FrameBuffer&) = delete;
+  FrameBuffer& operator=(const FrameBuffer&) = delete;
+
+  ///
+  /// Returns the first element of a plane
+  ///
+  /// @param[in] plane image plane
+  ///
+  /// @return uint8_t* plane data
+  ///
+  uint8_t* getPlane(frame_plane plane)
+  {
+    return planes_[plane];
+  }
+
+  ///
+  /// Redirects a plane to memory outside the buffer, e.g. the data of the
+  /// message the plane is published in, so rows are written in place
+  ///
+  /// @param[in] plane image plane
+  /// @param[in] data rows * getStep(plane) bytes, null to use the buffer's
+  /// own allocation again, or to unbind the plane if there is none
+  ///
+  void bindPlane(frame_plane plane, uint8_t* data)
+  {
+    planes_[plane] = data ? data : data_ ? data_ + offsets_[plane] : nullptr;
+  }
+
+  ///
+  /// Returns the first element of a plane row
+  ///
+  /// @param[in] plane image plane, T must match its element type
+  /// @param[in] row row index
+  ///
+  /// @return T* row data
+  ///
+  template <typename T>
+  T* getRow(frame_plane plane, size_t row)
+  {
+    return reinterpret_cast<T*>(getPlane(plane) + row * getStep(plane));
+  }
+
+  ///
+  /// Returns the size of a plane row in bytes
+  ///
+  /// @param[in] plane image plane
+  ///
+  /// @return size_t row step
+  ///
+  size_t getStep(frame_plane plane) const
+  {
+    return columns_ * getElementSize(plane);
+  }
+
+  ///
+  /// Returns the size of a plane element in bytes
+  ///
+  /// @param[in] plane image plane
+  ///
+  /// @return size_t element size
+  ///
+  static size_t getElementSize(frame_plane plane);
+
+  ///
+  /// Sets a row to no return: NaN depth, zero intensity and flags
+  ///
+  /// @param[in] row row index
+  ///
+  void clearRow(size_t row);
+
+  ///
+  /// Returns the number of rows
+  ///
+  /// @return uint16_t rows
+  ///
+  uint16_t getRows() const
+  {
+    return rows_;
+  }
+
+  ///
+  /// Returns the number of columns
+  ///
+  /// @return uint16_t columns
+  ///
+  uint16_t getColumns() const
+  {
+    return columns_;
+  }
+
+  ///
+  /// Returns the size of the allocation in bytes
+  ///
+  /// @return size_t buffer size, 0 without an allocation
+  ///
+  size_t getSize() const
+  {
+    return size_;
+  }
+
+private:
+  /// Number of rows
+  uint16_t rows_;
+
+  /// Number of columns
+  uint16_t columns_;
+
+  /// Plane offsets from data_ in bytes
+  size_t offsets_[plane_count];
+
+  /// First element of each plane, in data_ unless bound elsewhere
+  uint8_t* planes_[plane_count];
+
+  /// Size of the allocation in bytes, 0 without one
+  size_t size_;
+
+  /// Aligned allocation holding all planes, null without one
+  uint8_t* data_;
+};
+
+}  // namespace hfl
+
+#endif  // FRAME_BUFFER_H_
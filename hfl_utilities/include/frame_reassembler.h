@@ -0,0 +1,262 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// @file frame_reassembler.h
+///
+/// @brief This file defines the frame row reassembly class.
+///
+#ifndef FRAME_REASSEMBLER_H_
+#define FRAME_REASSEMBLER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hfl
+{
+/// Default number of frames reassembled concurrently
+const size_t REASSEMBLY_SLOTS{ 2 };
+/// Default time in seconds an incomplete frame is kept before eviction
+const double REASSEMBLY_TIMEOUT{ 0.1 };
+/// Frames further behind than this restart the frame history (sensor reboot)
+const int32_t REASSEMBLY_MAX_LAG{ 64 };
+
+/// Row insertion status
+enum row_status
+{
+  row_accepted = 0,
+  row_duplicate,
+  row_late,
+  row_invalid
+};
+
+///
+/// @brief Snapshot of one in-flight frame.
+///
+struct FrameSlotInfo
+{
+  /// Slot index
+  size_t slot{ 0 };
+
+  /// Sensor frame number
+  uint32_t frame_number{ 0 };
+
+  /// Bit i set if row i arrived
+  uint32_t row_mask{ 0 };
+
+  /// Arrival time of the first row in seconds
+  double start_time{ 0.0 };
+};
+
+///
+/// @brief Result of inserting one row.
+///
+struct RowInsertion
+{
+  /// Row status
+  row_status status{ row_invalid };
+
+  /// Slot holding the row's frame
+  size_t slot{ 0 };
+
+  /// True if the slot was (re)started for this frame and must be reset
+  bool started{ false };
+
+  /// True if all rows of the frame have arrived, the slot is free again
+  bool complete{ false };
+
+  /// True if an incomplete frame was pushed out of the slot to make room
+  bool evicted{ false };
+
+  /// Pushed out frame, valid if evicted is set
+  FrameSlotInfo evicted_frame;
+};
+
+///
+/// @brief Reassembles frames from rows arriving in any order.
+///
+/// Keeps a fixed number of in-flight frames keyed by their sensor frame
+/// number, each with a row bitmap. Only bookkeeping is done here, the
+/// caller owns the per-slot decode buffers, which stay untouched until
+/// a slot is started again, so evicted frames can still be inspected.
+///
+class FrameReassembler
+{
+public:
+  ///
+  /// FrameReassembler constructor
+  ///
+  /// @param rows number of rows per frame, at most 32
+  /// @param slots number of frames reassembled concurrently
+  /// @param timeout seconds an incomplete frame is kept
+  ///
+  FrameReassembler(uint16_t rows, size_t slots = REASSEMBLY_SLOTS, double timeout = REASSEMBLY_TIMEOUT);
+
+  ///
+  /// Inserts a row
+  ///
+  /// @param[in] frame_number sensor frame number
+  /// @param[in] row row index
+  /// @param[in] stamp arrival time in seconds
+  ///
+  /// @return RowInsertion insertion result
+  ///
+  RowInsertion insert(uint32_t frame_number, uint16_t row, double stamp);
+
+  ///
+  /// Evicts one frame older than the timeout
+  ///
+  /// @param[in] now current time in seconds
+  /// @param[out] frame evicted frame
+  ///
+  /// @return bool true if a frame was evicted, call again until false
+  ///
+  bool expire(double now, FrameSlotInfo& frame);
+
+  ///
+  /// Returns the number of slots
+  ///
+  /// @return size_t slot count
+  ///
+  size_t getSlotCount() const
+  {
+    return slots_.size();
+  }
+
+  ///
+  /// Returns the row mask of a complete frame
+  ///
+  /// @return uint32_t mask with one bit per row
+  ///
+  uint32_t getFullMask() const
+  {
+    return full_mask_;
+  }
+
+  ///
+  /// Returns the in-flight frame held by a slot
+  ///
+  /// @param[in] slot slot index
+  ///
+  /// @return FrameSlotInfo frame snapshot
+  ///
+  FrameSlotInfo getSlot(size_t slot) const;
+
+  ///
+  /// Returns the number of completed frames
+  ///
+  /// @return uint64_t completed frames
+  ///
+  uint64_t getCompletedCount() const
+  {
+    return completed_count_;
+  }
+
+  ///
+  /// Returns the number of rows that arrived after their frame was retired
+  ///
+  /// @return uint64_t late rows
+  ///
+  uint64_t getLateCount() const
+  {
+    return late_count_;
+  }
+
+  ///
+  /// Returns the number of incomplete frames evicted
+  ///
+  /// @return uint64_t evicted frames
+  ///
+  uint64_t getEvictedCount() const
+  {
+    return evicted_count_;
+  }
+
+  ///
+  /// Returns the number of rows received twice
+  ///
+  /// @return uint64_t duplicate rows
+  ///
+  uint64_t getDuplicateCount() const
+  {
+    return duplicate_count_;
+  }
+
+private:
+  /// In-flight frame slot
+  struct Slot
+  {
+    bool active{ false };
+    uint32_t frame_number{ 0 };
+    uint32_t row_mask{ 0 };
+    double start_time{ 0.0 };
+  };
+
+  /// Number of rows per frame
+  uint16_t rows_;
+
+  /// Row mask of a complete frame
+  uint32_t full_mask_;
+
+  /// Incomplete frame timeout in seconds
+  double timeout_;
+
+  /// Frame slots
+  std::vector<Slot> slots_;
+
+  /// True once a frame was retired
+  bool has_retired_;
+
+  /// Newest completed or evicted frame number
+  uint32_t newest_retired_;
+
+  /// Completed frame counter
+  uint64_t completed_count_;
+
+  /// Late row counter
+  uint64_t late_count_;
+
+  /// Evicted frame counter
+  uint64_t evicted_count_;
+
+  /// Duplicate row counter
+  uint64_t duplicate_count_;
+
+  ///
+  /// Frees a slot and records its frame as retired
+  ///
+  /// @param[in] slot slot index
+  ///
+  void retire(size_t slot);
+};
+
+}  // namespace hfl
+#endif  // FRAME_REASSEMBLER_H_
@@ -38,6 +38,8 @@
 #define HFL_INTERFACE_H_
 #include <hfl_configs.h>
 #include <hfl_frame.h>
+#include <hfl_packet.h>
+#include <stage_profiler.h>
 
 #ifdef _WIN32
 #include <winsock2.h>
@@ -45,6 +47,8 @@
 #include <arpa/inet.h>  // ntohl()
 #endif
 
+#include <atomic>
+#include <cstring>
 #include <string>
 #include <vector>
 #include <memory>
@@ -57,6 +61,19 @@ static inline float big_to_native(float x)
   return ntohl(x);
 }
 
+static inline uint64_t big_to_native(uint64_t x)
+{
+  // Assemble from the bytes in memory order, correct on any host byte order
+  uint8_t bytes[sizeof(x)];
+  memcpy(bytes, &x, sizeof(x));
+  uint64_t value = 0;
+  for (size_t i = 0; i < sizeof(x); i += 1)
+  {
+    value = (value << 8) | bytes[i];
+  }
+  return value;
+}
+
 static inline uint32_t big_to_native(uint32_t x)
 {
   return ntohl(x);
@@ -120,8 +137,9 @@ protected:
   double yaw_;
   bool extrinsics_reconfigured_;
 
-  /// time offset
-  double time_offset_;
+  /// time offset residual added to synchronized stamps in seconds, set by
+  /// dynamic reconfigure while frames are stamped
+  std::atomic<double> time_offset_;
 
   /// global range offset
   double global_offset_;
@@ -129,6 +147,9 @@ protected:
   /// Camera's frame configurations
   std::shared_ptr<hfl::Frame> frame_;
 
+  /// Processing stage profiler, null if profiling is disabled
+  std::shared_ptr<StageProfiler> profiler_;
+
 public:
   ///
   /// Gets the Model of the camera.
@@ -224,6 +245,15 @@ public:
   ///
   virtual bool setExtrinsicTranslatationZ(double z) = 0;
 
+  ///
+  /// Sets time offset residual
+  ///
+  /// @param[in] offset seconds added to synchronized stamps
+  ///
+  /// @return bool true if given time offset is set
+  ///
+  virtual bool setTimeOffset(double offset) = 0;
+
   ///
   /// Sets extrinsics_reconfigured flag
   ///
@@ -240,7 +270,7 @@ public:
   ///
   /// @return bool true if successfully parsed frame data
   ///
-  virtual bool parseFrame(int start_byte, const std::vector<uint8_t>& packet) = 0;
+  virtual bool parseFrame(int start_byte, PacketView packet) = 0;
 
   ///
   /// Process the frame data from udp packets
@@ -249,7 +279,7 @@ public:
   ///
   /// @return bool
   ///
-  virtual bool processFrameData(const std::vector<uint8_t>& data) = 0;
+  virtual bool processFrameData(PacketView data) = 0;
 
   ///
   /// Parse packet into objects
@@ -258,7 +288,7 @@ public:
   ///
   /// @return bool true if successfully parsed object data
   ///
-  virtual bool parseObjects(int start_byte, const std::vector<uint8_t>& packet) = 0;
+  virtual bool parseObjects(int start_byte, PacketView packet) = 0;
 
   ///
   /// Process the object data from udp packets
@@ -267,7 +297,7 @@ public:
   ///
   /// @return bool
   ///
-  virtual bool processObjectData(const std::vector<uint8_t>& data) = 0;
+  virtual bool processObjectData(PacketView data) = 0;
 
   ///
   /// Process the telemetry data from udp packets
@@ -276,7 +306,7 @@ public:
   ///
   /// @return bool
   ///
-  virtual bool processTelemetryData(const std::vector<uint8_t>& data) = 0;
+  virtual bool processTelemetryData(PacketView data) = 0;
 
   ///
   /// Process the slice data from udp packets
@@ -285,7 +315,24 @@ public:
   ///
   /// @return bool
   ///
-  virtual bool processSliceData(const std::vector<uint8_t>& data) = 0;
+  virtual bool processSliceData(PacketView data) = 0;
+
+  ///
+  /// Process a packet of any channel
+  ///
+  /// @param[in] channel channel the packet arrived on
+  /// @param[in] data packet data
+  ///
+  /// @return bool false if the channel is not processed
+  ///
+  bool processPacket(packet_channel channel, PacketView data);
+
+  ///
+  /// Sets the processing stage profiler
+  ///
+  /// @param[in] profiler profiler with the camera's stages, null to disable
+  ///
+  void setProfiler(std::shared_ptr<StageProfiler> profiler);
   
   ///
   /// Reference to the frame_ member variable
@@ -0,0 +1,247 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// @file hfl_packet.h
+///
+/// @brief This file defines the packet buffer and packet view types.
+///
+#ifndef HFL_PACKET_H_
+#define HFL_PACKET_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hfl
+{
+/// Packet buffer size (Ethernet MTU rounded up to a multiple of 64 bytes)
+const size_t PACKET_BUFFER_SIZE{ 1536 };
+
+/// Sensor data channels, one UDP port each
+enum packet_channel
+{
+  channel_frame = 0,
+  channel_pdm,
+  channel_object,
+  channel_tele,
+  channel_slice,
+  channel_count
+};
+
+///
+/// @brief Non-owning view of a received datagram.
+///
+/// Implicitly constructible from a std::vector so existing callers
+/// holding a vector (e.g. udp_com messages) can still pass it directly.
+///
+class PacketView
+{
+public:
+  ///
+  /// Empty packet view constructor
+  ///
+  PacketView() : data_(nullptr), size_(0), receive_time_(0)
+  {
+  }
+
+  ///
+  /// Packet view constructor
+  ///
+  /// @param data pointer to the first packet byte
+  /// @param size packet size in bytes
+  /// @param receive_time kernel receive time in nanoseconds since epoch, 0 if unknown
+  ///
+  PacketView(const uint8_t* data, size_t size, uint64_t receive_time = 0)
+    : data_(data), size_(size), receive_time_(receive_time)
+  {
+  }
+
+  ///
+  /// Packet view constructor from a byte vector
+  ///
+  /// @param data packet bytes
+  ///
+  PacketView(const std::vector<uint8_t>& data)  // NOLINT
+    : data_(data.data()), size_(data.size()), receive_time_(0)
+  {
+  }
+
+  ///
+  /// Returns the byte at the given offset
+  ///
+  /// @param index byte offset
+  ///
+  /// @return const reference to the byte
+  ///
+  const uint8_t& operator[](size_t index) const
+  {
+    return data_[index];
+  }
+
+  ///
+  /// Returns the pointer to the first packet byte
+  ///
+  /// @return const uint8_t* packet data
+  ///
+  const uint8_t* data() const
+  {
+    return data_;
+  }
+
+  ///
+  /// Returns the packet size
+  ///
+  /// @return size_t packet size in bytes
+  ///
+  size_t size() const
+  {
+    return size_;
+  }
+
+  ///
+  /// Returns true if the view holds no bytes
+  ///
+  /// @return bool true if empty
+  ///
+  bool empty() const
+  {
+    return size_ == 0;
+  }
+
+  ///
+  /// Returns the time the datagram was received by the kernel
+  ///
+  /// @return uint64_t nanoseconds since epoch, 0 if unknown
+  ///
+  uint64_t getReceiveTime() const
+  {
+    return receive_time_;
+  }
+
+private:
+  /// First packet byte
+  const uint8_t* data_;
+
+  /// Packet size in bytes
+  size_t size_;
+
+  /// Kernel receive time in nanoseconds since epoch, 0 if unknown
+  uint64_t receive_time_;
+};
+
+///
+/// @brief Fixed size buffer holding one received datagram.
+///
+struct PacketBuffer
+{
+  /// Datagram bytes
+  uint8_t data[PACKET_BUFFER_SIZE];
+
+  /// Datagram size in bytes
+  size_t size{ 0 };
+
+  /// Local UDP port the datagram arrived on
+  uint16_t port{ 0 };
+
+  /// Kernel receive time in nanoseconds since epoch, 0 if unknown
+  uint64_t receive_time{ 0 };
+
+  ///
+  /// Returns a view of the received bytes
+  ///
+  /// @return PacketView datagram view
+  ///
+  PacketView view() const
+  {
+    return PacketView(data, size, receive_time);
+  }
+};
+
+///
+/// @brief Preallocated ring of packet buffers.
+///
+/// All buffers are allocated once at construction and reused, so
+/// receiving a datagram never allocates.
+///
+class PacketPool
+{
+public:
+  ///
+  /// PacketPool constructor
+  ///
+  /// @param capacity number of packet buffers, rounded up to a power of two
+  ///
+  explicit PacketPool(size_t capacity);
+
+  ///
+  /// Returns the buffer at the given ring position
+  ///
+  /// @param index ring position, wraps around the pool capacity
+  ///
+  /// @return PacketBuffer reference
+  ///
+  PacketBuffer& at(size_t index)
+  {
+    return buffers_[index & mask_];
+  }
+
+  ///
+  /// Returns the buffer at the given ring position
+  ///
+  /// @param index ring position, wraps around the pool capacity
+  ///
+  /// @return PacketBuffer const reference
+  ///
+  const PacketBuffer& at(size_t index) const
+  {
+    return buffers_[index & mask_];
+  }
+
+  ///
+  /// Returns the number of packet buffers
+  ///
+  /// @return size_t pool capacity
+  ///
+  size_t capacity() const
+  {
+    return buffers_.size();
+  }
+
+private:
+  /// Packet buffers
+  std::vector<PacketBuffer> buffers_;
+
+  /// Ring position mask
+  size_t mask_;
+};
+
+}  // namespace hfl
+#endif  // HFL_PACKET_H_
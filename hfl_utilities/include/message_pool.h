@@ -0,0 +1,202 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// @file message_pool.h
+///
+/// @brief This file defines the recycling message pool.
+///
+#ifndef MESSAGE_POOL_H_
+#define MESSAGE_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace hfl
+{
+///
+/// @brief Hands out messages that return to the pool when released.
+///
+/// Messages are handed out as shared pointers whose deleter puts them
+/// back, so a message is reused once its last holder, publisher queue or
+/// subscriber, lets go. Reused messages keep their buffer capacity, so
+/// filling them again does not allocate. When all messages are in use a
+/// new one is created and counted as a miss; it joins the pool when
+/// released, so the pool grows to the steady state demand.
+///
+/// The pool may be destroyed while messages are still held, they are
+/// deleted when released.
+///
+/// @tparam T message type
+///
+template <typename T>
+class MessagePool
+{
+public:
+  ///
+  /// MessagePool constructor, creates the initial messages
+  ///
+  /// @param size number of messages created up front
+  /// @param init called once on every message the pool creates, may be empty
+  ///
+  explicit MessagePool(size_t size, std::function<void(T&)> init = std::function<void(T&)>())
+    : storage_(std::make_shared<Storage>())
+  {
+    storage_->init = init;
+    for (size_t i = 0; i < size; i += 1)
+    {
+      storage_->available.push_back(storage_->create());
+    }
+  }
+
+  MessagePool(const MessagePool&) = delete;
+  MessagePool& operator=(const MessagePool&) = delete;
+
+  ///
+  /// Takes a message from the pool, creates one if none is available
+  ///
+  /// @tparam Ptr shared pointer type taking a deleter, e.g. boost::shared_ptr<T>
+  ///
+  /// @return Ptr message, returns to the pool when the last copy is destroyed
+  ///
+  template <typename Ptr = std::shared_ptr<T>>
+  Ptr acquire()
+  {
+    T* message = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(storage_->mutex);
+      if (!storage_->available.empty())
+      {
+        message = storage_->available.back();
+        storage_->available.pop_back();
+      }
+      else
+      {
+        storage_->misses += 1;
+      }
+    }
+    if (!message)
+    {
+      message = storage_->create();
+    }
+    return Ptr(message, Recycler{ storage_ });
+  }
+
+  ///
+  /// Returns the number of messages owned by the pool, in use or not
+  ///
+  /// @return size_t messages
+  ///
+  size_t getSize() const
+  {
+    std::lock_guard<std::mutex> lock(storage_->mutex);
+    return storage_->size;
+  }
+
+  ///
+  /// Returns the number of messages ready to be handed out
+  ///
+  /// @return size_t messages
+  ///
+  size_t getAvailable() const
+  {
+    std::lock_guard<std::mutex> lock(storage_->mutex);
+    return storage_->available.size();
+  }
+
+  ///
+  /// Returns the number of requests that found no available message
+  ///
+  /// @return uint64_t misses
+  ///
+  uint64_t getMisses() const
+  {
+    std::lock_guard<std::mutex> lock(storage_->mutex);
+    return storage_->misses;
+  }
+
+private:
+  /// Messages and counters, shared with the deleters of handed out messages
+  struct Storage
+  {
+    Storage() : size(0), misses(0)
+    {
+    }
+
+    ~Storage()
+    {
+      for (T* message : available)
+      {
+        delete message;
+      }
+    }
+
+    /// Creates a message owned by the pool
+    T* create()
+    {
+      T* message = new T();
+      if (init)
+      {
+        init(*message);
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      size += 1;
+      return message;
+    }
+
+    std::mutex mutex;
+    std::vector<T*> available;
+    std::function<void(T&)> init;
+    size_t size;
+    uint64_t misses;
+  };
+
+  /// Deleter putting a message back into its pool
+  struct Recycler
+  {
+    void operator()(T* message) const
+    {
+      std::lock_guard<std::mutex> lock(storage->mutex);
+      storage->available.push_back(message);
+    }
+
+    std::shared_ptr<Storage> storage;
+  };
+
+  /// Shared with every handed out message
+  std::shared_ptr<Storage> storage_;
+};
+
+}  // namespace hfl
+#endif  // MESSAGE_POOL_H_
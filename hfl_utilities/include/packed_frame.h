@@ -0,0 +1,212 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// @file packed_frame.h
+///
+/// @brief This file defines the layout of the packed frame buffer.
+///
+#ifndef PACKED_FRAME_H_
+#define PACKED_FRAME_H_
+
+#include <row_decoder.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace hfl
+{
+/// Planes of a packed frame, in buffer order
+enum packed_plane
+{
+  packed_range = 0,
+  packed_range2,
+  packed_intensity,
+  packed_intensity2,
+  packed_flags,
+  packed_plane_count
+};
+
+///
+/// @brief Locates the planes of a frame packed into one contiguous buffer.
+///
+/// Ranges are float meters, intensities uint16_t and flags the sensor's
+/// classification byte (FLAG_* bits), each plane row major and stored
+/// right after the previous one. Every plane starts on a multiple of its
+/// element size, so consumers can view the planes in place.
+///
+class PackedFrameLayout
+{
+public:
+  ///
+  /// PackedFrameLayout constructor
+  ///
+  /// @param rows number of rows per frame
+  /// @param columns number of columns per frame
+  ///
+  PackedFrameLayout(uint16_t rows, uint16_t columns);
+
+  ///
+  /// Returns the offset of a plane in the buffer
+  ///
+  /// @param[in] plane packed plane
+  ///
+  /// @return size_t offset in bytes
+  ///
+  size_t getOffset(packed_plane plane) const
+  {
+    return offsets_[plane];
+  }
+
+  ///
+  /// Returns the size of a plane row in bytes
+  ///
+  /// @param[in] plane packed plane
+  ///
+  /// @return size_t row step
+  ///
+  size_t getStep(packed_plane plane) const
+  {
+    return columns_ * getElementSize(plane);
+  }
+
+  ///
+  /// Returns the size of a plane element in bytes
+  ///
+  /// @param[in] plane packed plane
+  ///
+  /// @return size_t element size
+  ///
+  static size_t getElementSize(packed_plane plane);
+
+  ///
+  /// Returns the first element of a plane row
+  ///
+  /// @param[in] data packed buffer, getSize() bytes
+  /// @param[in] plane packed plane, T must match its element type
+  /// @param[in] row row index
+  ///
+  /// @return T* row data
+  ///
+  template <typename T>
+  T* getRow(uint8_t* data, packed_plane plane, size_t row) const
+  {
+    return reinterpret_cast<T*>(data + offsets_[plane] + row * getStep(plane));
+  }
+
+  template <typename T>
+  const T* getRow(const uint8_t* data, packed_plane plane, size_t row) const
+  {
+    return reinterpret_cast<const T*>(data + offsets_[plane] + row * getStep(plane));
+  }
+
+  ///
+  /// Returns the range and intensity planes of a row, to decode into
+  ///
+  /// @param[in] data packed buffer
+  /// @param[in] row row index
+  ///
+  /// @return DecodedRow row planes
+  ///
+  DecodedRow getRangeRow(uint8_t* data, size_t row) const;
+
+  ///
+  /// Copies a decoded row into the range and intensity planes
+  ///
+  /// @param[out] data packed buffer
+  /// @param[in] row row index
+  /// @param[in] ranges decoded ranges and intensities of the row
+  ///
+  void copyRanges(uint8_t* data, size_t row, const DecodedRow& ranges) const;
+
+  ///
+  /// Copies the classification flag bytes of a row into the flag plane
+  ///
+  /// @param[out] data packed buffer
+  /// @param[in] row row index
+  /// @param[in] flags flag bytes of the row, no alignment required
+  ///
+  void copyFlags(uint8_t* data, size_t row, const uint8_t* flags) const;
+
+  ///
+  /// Sets a row to no return: NaN range, zero intensity and flags
+  ///
+  /// @param[out] data packed buffer
+  /// @param[in] row row index
+  ///
+  void clearRow(uint8_t* data, size_t row) const;
+
+  ///
+  /// Returns the number of rows
+  ///
+  /// @return uint16_t rows
+  ///
+  uint16_t getRows() const
+  {
+    return rows_;
+  }
+
+  ///
+  /// Returns the number of columns
+  ///
+  /// @return uint16_t columns
+  ///
+  uint16_t getColumns() const
+  {
+    return columns_;
+  }
+
+  ///
+  /// Returns the size of the packed buffer in bytes
+  ///
+  /// @return size_t buffer size
+  ///
+  size_t getSize() const
+  {
+    return size_;
+  }
+
+private:
+  /// Number of rows
+  uint16_t rows_;
+
+  /// Number of columns
+  uint16_t columns_;
+
+  /// Plane offsets in bytes
+  size_t offsets_[packed_plane_count];
+
+  /// Size of the packed buffer in bytes
+  size_t size_;
+};
+
+}  // namespace hfl
+
+#endif  // PACKED_FRAME_H_
@@ -0,0 +1,201 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// @file packet_encoder.h
+///
+/// @brief This file defines the HFL110DCU packet encoder used to emulate sensors.
+///
+#ifndef PACKET_ENCODER_H_
+#define PACKET_ENCODER_H_
+
+#include <hfl_packet.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace hfl
+{
+/// Pixel columns per frame packet
+const size_t ENCODER_COLUMNS{ 128 };
+/// Frame packet size in bytes
+const size_t FRAME_PACKET_SIZE{ 1372 };
+/// Offset of the pixel data in a frame packet
+const size_t FRAME_DATA_OFFSET{ 92 };
+/// Offset of the first object in an object packet
+const size_t OBJECT_DATA_OFFSET{ 14 };
+/// Size of one object record
+const size_t OBJECT_RECORD_SIZE{ 129 };
+/// Objects in the first and second object packet of a frame
+const size_t OBJECTS_FIRST_PACKET{ 11 };
+const size_t OBJECTS_SECOND_PACKET{ 9 };
+/// Telemetry packet size in bytes
+const size_t TELEMETRY_PACKET_SIZE{ 67 };
+/// Slice packet size in bytes
+const size_t SLICE_PACKET_SIZE{ 268 };
+
+///
+/// @brief Intrinsic and extrinsic calibration sent with every frame row.
+///
+struct SensorCalibration
+{
+  /// Intrinsics, bytes 20 to 52
+  float fx{ 37.0f };
+  float fy{ 37.0f };
+  float ux{ 64.0f };
+  float uy{ 16.0f };
+  float r1{ 0.0f };
+  float r2{ 0.0f };
+  float t1{ 0.0f };
+  float t2{ 0.0f };
+  float r4{ 0.0f };
+
+  /// Extrinsics, bytes 56 to 84
+  float intrinsic_yaw{ 0.0f };
+  float intrinsic_pitch{ 0.0f };
+  float extrinsic_yaw{ 0.0f };
+  float extrinsic_pitch{ 0.0f };
+  float extrinsic_roll{ 0.0f };
+  float extrinsic_z{ 1.0f };
+  float extrinsic_y{ 0.0f };
+  float extrinsic_x{ 0.0f };
+};
+
+///
+/// @brief Pixel data of one frame row.
+///
+struct FrameRowData
+{
+  /// Raw ranges (meters * 256) of both returns
+  uint16_t range[ENCODER_COLUMNS][2];
+
+  /// Intensities of both returns
+  uint16_t intensity[ENCODER_COLUMNS][2];
+
+  /// Classification flags
+  uint8_t flags[ENCODER_COLUMNS];
+};
+
+///
+/// @brief Tracked object as encoded in object packets.
+///
+struct EncodedObject
+{
+  /// Center position and size in meters
+  float x{ 0.0f };
+  float y{ 0.0f };
+  float length{ 0.0f };
+  float width{ 0.0f };
+  float height{ 0.0f };
+
+  /// Heading in radians
+  float yaw{ 0.0f };
+
+  /// Absolute velocity in meters per second
+  float vx{ 0.0f };
+  float vy{ 0.0f };
+
+  /// Object class and confidence in percent
+  uint8_t classification{ 0 };
+  uint8_t confidence{ 0 };
+};
+
+///
+/// @brief Encodes datagrams in the layout HFL110DCU v1 sensors send.
+///
+class PacketEncoder
+{
+public:
+  ///
+  /// PacketEncoder constructor
+  ///
+  /// @param calibration calibration sent with every frame row
+  ///
+  explicit PacketEncoder(const SensorCalibration& calibration = SensorCalibration());
+
+  ///
+  /// Encodes a frame row packet
+  ///
+  /// @param[out] buffer packet buffer
+  /// @param[in] frame_number sensor frame number
+  /// @param[in] packet_row row index on the wire, 0 is sent first
+  /// @param[in] sensor_time sensor timestamp in ticks
+  /// @param[in] row pixel data
+  ///
+  void encodeFrameRow(PacketBuffer& buffer, uint32_t frame_number, uint32_t packet_row,
+                      uint64_t sensor_time, const FrameRowData& row) const;
+
+  ///
+  /// Updates frame number and timestamp of an encoded frame row packet
+  ///
+  /// @param[in,out] buffer packet buffer
+  /// @param[in] frame_number sensor frame number
+  /// @param[in] sensor_time sensor timestamp in ticks
+  ///
+  static void setFrameHeader(PacketBuffer& buffer, uint32_t frame_number, uint64_t sensor_time);
+
+  ///
+  /// Encodes an object packet, a frame's objects are sent in two packets
+  ///
+  /// @param[out] buffer packet buffer
+  /// @param[in] objects objects of this packet
+  /// @param[in] count number of objects, at most OBJECTS_FIRST_PACKET
+  /// @param[in] last true for the second packet, which publishes the objects
+  ///
+  void encodeObjects(PacketBuffer& buffer, const EncodedObject* objects, size_t count,
+                     bool last) const;
+
+  ///
+  /// Encodes a telemetry packet
+  ///
+  /// @param[out] buffer packet buffer
+  /// @param[in] frame_counter sensor frame counter
+  /// @param[in] sensor_temperature sensor temperature in degrees Celsius
+  /// @param[in] serial_number sensor serial number, at most 26 characters
+  ///
+  void encodeTelemetry(PacketBuffer& buffer, uint32_t frame_counter, float sensor_temperature,
+                       const std::string& serial_number) const;
+
+  ///
+  /// Encodes a slice packet
+  ///
+  /// @param[out] buffer packet buffer
+  /// @param[in] frame_number sensor frame number
+  /// @param[in] sensor_time sensor timestamp in ticks
+  ///
+  void encodeSlice(PacketBuffer& buffer, uint32_t frame_number, uint64_t sensor_time) const;
+
+private:
+  /// Calibration sent with every frame row
+  SensorCalibration calibration_;
+};
+
+}  // namespace hfl
+#endif  // PACKET_ENCODER_H_
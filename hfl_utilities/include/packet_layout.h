@@ -0,0 +1,465 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// @file packet_layout.h
+///
+/// @brief This file defines compile-time layouts of the HFL110DCU packets.
+///
+/// A layout is a struct of typedefs, one per wire field, each carrying its
+/// offset, type and byte order. Fields are loaded with memcpy, so packets
+/// need no alignment, and byte swaps are resolved at compile time. A new
+/// firmware layout is a new layout struct used with the same views.
+///
+#ifndef PACKET_LAYOUT_H_
+#define PACKET_LAYOUT_H_
+
+#include <hfl_packet.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace hfl
+{
+/// Byte order of a wire field
+enum byte_order
+{
+  order_big_endian = 0,
+  order_little_endian
+};
+
+/// Byte order of the host
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+const byte_order HOST_BYTE_ORDER{ order_big_endian };
+#else
+const byte_order HOST_BYTE_ORDER{ order_little_endian };
+#endif
+
+namespace layout
+{
+/// Unsigned integer of the same size as a field type
+template <size_t Size>
+struct Bits;
+template <>
+struct Bits<1>
+{
+  typedef uint8_t type;
+};
+template <>
+struct Bits<2>
+{
+  typedef uint16_t type;
+};
+template <>
+struct Bits<4>
+{
+  typedef uint32_t type;
+};
+template <>
+struct Bits<8>
+{
+  typedef uint64_t type;
+};
+
+inline uint8_t swap(uint8_t x)
+{
+  return x;
+}
+
+inline uint16_t swap(uint16_t x)
+{
+  return __builtin_bswap16(x);
+}
+
+inline uint32_t swap(uint32_t x)
+{
+  return __builtin_bswap32(x);
+}
+
+inline uint64_t swap(uint64_t x)
+{
+  return __builtin_bswap64(x);
+}
+
+/// Loads a value stored in the given byte order from unaligned memory
+template <typename T, byte_order Order>
+inline T load(const uint8_t* data)
+{
+  typedef typename Bits<sizeof(T)>::type Raw;
+  Raw raw;
+  memcpy(&raw, data, sizeof(raw));
+  if (Order != HOST_BYTE_ORDER)
+  {
+    raw = swap(raw);
+  }
+  T value;
+  memcpy(&value, &raw, sizeof(value));
+  return value;
+}
+
+/// Stores a value in the given byte order to unaligned memory
+template <typename T, byte_order Order>
+inline void store(uint8_t* data, T value)
+{
+  typedef typename Bits<sizeof(T)>::type Raw;
+  Raw raw;
+  memcpy(&raw, &value, sizeof(raw));
+  if (Order != HOST_BYTE_ORDER)
+  {
+    raw = swap(raw);
+  }
+  memcpy(data, &raw, sizeof(raw));
+}
+}  // namespace layout
+
+///
+/// @brief Scalar wire field.
+///
+/// @tparam T field type
+/// @tparam Offset byte offset from the start of the layout
+/// @tparam Order byte order on the wire
+///
+template <typename T, size_t Offset, byte_order Order = order_big_endian>
+struct Field
+{
+  typedef T type;
+  static const size_t offset = Offset;
+  static const size_t end = Offset + sizeof(T);
+
+  static T load(const uint8_t* data)
+  {
+    return layout::load<T, Order>(data + Offset);
+  }
+
+  static void store(uint8_t* data, T value)
+  {
+    layout::store<T, Order>(data + Offset, value);
+  }
+};
+
+template <typename T, size_t Offset, byte_order Order>
+const size_t Field<T, Offset, Order>::offset;
+template <typename T, size_t Offset, byte_order Order>
+const size_t Field<T, Offset, Order>::end;
+
+///
+/// @brief Array of equally typed wire fields.
+///
+/// @tparam T element type
+/// @tparam Offset byte offset of the first element
+/// @tparam Count number of elements
+/// @tparam Order byte order on the wire
+///
+template <typename T, size_t Offset, size_t Count, byte_order Order = order_big_endian>
+struct FieldArray
+{
+  typedef T type;
+  static const size_t offset = Offset;
+  static const size_t count = Count;
+  static const size_t end = Offset + Count * sizeof(T);
+
+  static T load(const uint8_t* data, size_t index)
+  {
+    return layout::load<T, Order>(data + Offset + index * sizeof(T));
+  }
+
+  static void store(uint8_t* data, size_t index, T value)
+  {
+    layout::store<T, Order>(data + Offset + index * sizeof(T), value);
+  }
+
+  ///
+  /// Loads all elements into a struct or array of Count elements of T
+  ///
+  template <typename Out>
+  static void loadAll(const uint8_t* data, Out& out)
+  {
+    static_assert(sizeof(Out) == Count * sizeof(T), "destination does not match field array");
+    T values[Count];
+    for (size_t i = 0; i < Count; i += 1)
+    {
+      values[i] = load(data, i);
+    }
+    memcpy(&out, values, sizeof(out));
+  }
+};
+
+template <typename T, size_t Offset, size_t Count, byte_order Order>
+const size_t FieldArray<T, Offset, Count, Order>::offset;
+template <typename T, size_t Offset, size_t Count, byte_order Order>
+const size_t FieldArray<T, Offset, Count, Order>::count;
+template <typename T, size_t Offset, size_t Count, byte_order Order>
+const size_t FieldArray<T, Offset, Count, Order>::end;
+
+///
+/// @brief Range of raw bytes, decoded elsewhere.
+///
+/// @tparam Offset byte offset of the first byte
+/// @tparam Size size in bytes
+///
+template <size_t Offset, size_t Size>
+struct Block
+{
+  static const size_t offset = Offset;
+  static const size_t size = Size;
+  static const size_t end = Offset + Size;
+};
+
+template <size_t Offset, size_t Size>
+const size_t Block<Offset, Size>::offset;
+template <size_t Offset, size_t Size>
+const size_t Block<Offset, Size>::size;
+template <size_t Offset, size_t Size>
+const size_t Block<Offset, Size>::end;
+
+///
+/// @brief HFL110DCU v1 frame row packet.
+///
+struct FrameLayoutV1
+{
+  /// Header, big endian
+  typedef Field<uint16_t, 0> UdpVersion;
+  typedef Field<uint16_t, 2> PcaVersion;
+  typedef Field<uint64_t, 4> Timestamp;
+  typedef Field<uint32_t, 12> FrameNumber;
+  typedef Field<uint32_t, 16> RowNumber;
+
+  /// Intrinsics, little endian
+  typedef Field<float, 20, order_little_endian> Fx;
+  typedef Field<float, 24, order_little_endian> Fy;
+  typedef Field<float, 28, order_little_endian> Ux;
+  typedef Field<float, 32, order_little_endian> Uy;
+  typedef Field<float, 36, order_little_endian> R1;
+  typedef Field<float, 40, order_little_endian> R2;
+  typedef Field<float, 44, order_little_endian> T1;
+  typedef Field<float, 48, order_little_endian> T2;
+  typedef Field<float, 52, order_little_endian> R4;
+
+  /// Extrinsics, little endian
+  typedef Field<float, 56, order_little_endian> IntrinsicYaw;
+  typedef Field<float, 60, order_little_endian> IntrinsicPitch;
+  typedef Field<float, 64, order_little_endian> ExtrinsicYaw;
+  typedef Field<float, 68, order_little_endian> ExtrinsicPitch;
+  typedef Field<float, 72, order_little_endian> ExtrinsicRoll;
+  typedef Field<float, 76, order_little_endian> ExtrinsicZ;
+  typedef Field<float, 80, order_little_endian> ExtrinsicY;
+  typedef Field<float, 84, order_little_endian> ExtrinsicX;
+  typedef Field<uint32_t, 88, order_little_endian> CalibrationStatus;
+
+  /// Calibration block, intrinsics and extrinsics, with and without status
+  typedef Block<20, 72> Calibration;
+  typedef Block<20, 68> CalibrationParameters;
+
+  /// Row pixel data: interleaved big endian ranges and intensities of both
+  /// returns, 128 columns each, 128 reserved bytes and one flag byte per column
+  typedef FieldArray<uint16_t, 92, 256> Ranges;
+  typedef FieldArray<uint16_t, 604, 256> Intensities;
+  typedef Block<1116, 128> Reserved;
+  typedef FieldArray<uint8_t, 1244, 128> Flags;
+  typedef Block<92, 1280> Pixels;
+
+  /// Whole packet
+  typedef Block<0, 1372> Packet;
+
+  static_assert(Timestamp::offset == UdpVersion::end + 2, "timestamp follows the versions");
+  static_assert(Fx::offset == RowNumber::end, "intrinsics follow the header");
+  static_assert(CalibrationStatus::end == Calibration::end, "status ends the calibration");
+  static_assert(CalibrationParameters::end == CalibrationStatus::offset, "status follows the parameters");
+  static_assert(Calibration::end == Pixels::offset, "pixels follow the calibration");
+  static_assert(Intensities::offset - Ranges::offset == 512, "intensities follow the ranges");
+  static_assert(Intensities::end + 128 == Flags::offset, "128 bytes separate the intensities from the flags");
+  static_assert(Reserved::offset == Intensities::end && Reserved::end == Flags::offset,
+                "reserved bytes fill the gap between intensities and flags");
+  static_assert(Flags::offset - Pixels::offset == 1152, "flags start 1152 bytes into the pixel data");
+  static_assert(Flags::end == Pixels::end && Pixels::end == Packet::end, "pixels end the packet");
+};
+
+///
+/// @brief HFL110DCU v1 object packet, a header followed by object records.
+///
+struct ObjectLayoutV1
+{
+  /// Bit 0 set in the second packet of a frame
+  typedef Field<uint32_t, 10> PacketIndex;
+
+  /// First object record
+  typedef Block<14, 0> Records;
+
+  static_assert(PacketIndex::end == Records::offset, "records follow the header");
+};
+
+///
+/// @brief HFL110DCU v1 object record, little endian.
+///
+struct ObjectRecordLayoutV1
+{
+  /// Box corners, height, ground offset, distance and yaw
+  typedef FieldArray<float, 0, 11, order_little_endian> Geometry;
+
+  /// Velocities, acceleration and covariances
+  typedef FieldArray<float, 44, 20, order_little_endian> Kinematics;
+
+  typedef Field<uint8_t, 124> State;
+  typedef Field<uint8_t, 125> DynamicProperties;
+  typedef Field<uint8_t, 126> Quality;
+  typedef Field<uint8_t, 127> Classification;
+  typedef Field<uint8_t, 128> Confidence;
+
+  /// Whole record, records are packed back to back
+  typedef Block<0, 129> Record;
+
+  static_assert(Geometry::end == Kinematics::offset, "kinematics follow the geometry");
+  static_assert(Kinematics::end == State::offset, "state follows the kinematics");
+  static_assert(Confidence::end == Record::end, "confidence ends the record");
+};
+
+///
+/// @brief HFL110DCU v1 telemetry packet.
+///
+struct TelemetryLayoutV1
+{
+  typedef Field<uint32_t, 0> HardwareRevision;
+  typedef Field<float, 4, order_little_endian> SensorTemperature;
+  /// Sent negated
+  typedef Field<float, 8, order_little_endian> HeaterTemperature;
+  typedef Field<uint32_t, 12> FrameCounter;
+  typedef Field<float, 16, order_little_endian> UbattSwitched;
+  typedef Field<float, 20, order_little_endian> Ubatt;
+  typedef Field<float, 24, order_little_endian> HeaterLens;
+  typedef Field<float, 28, order_little_endian> HeaterLensHigh;
+  typedef Field<float, 32, order_little_endian> Temperature0Lens;
+  typedef Field<float, 36, order_little_endian> AcquisitionPeriod;
+  typedef Field<uint8_t, 40> TemperatureSensorFeedback;
+
+  /// Serial number characters in reverse order
+  typedef FieldArray<char, 41, 26> SerialNumber;
+
+  /// Whole packet
+  typedef Block<0, 67> Packet;
+
+  static_assert(SerialNumber::end == Packet::end, "serial number ends the packet");
+};
+
+///
+/// @brief Zero-copy view of a packet with a compile-time layout.
+///
+/// @tparam Layout packet layout, its Packet block gives the minimum size
+///
+template <typename Layout>
+class LayoutView
+{
+public:
+  ///
+  /// LayoutView constructor
+  ///
+  /// @param data first byte of the layout, no alignment required
+  ///
+  explicit LayoutView(const uint8_t* data) : data_(data)
+  {
+  }
+
+  ///
+  /// LayoutView constructor
+  ///
+  /// @param packet packet starting with the layout
+  ///
+  explicit LayoutView(PacketView packet) : data_(packet.data())
+  {
+  }
+
+  ///
+  /// Returns the value of a field
+  ///
+  /// @tparam F field of the layout
+  ///
+  /// @return typename F::type field value in host order
+  ///
+  template <typename F>
+  typename F::type get() const
+  {
+    return F::load(data_);
+  }
+
+  ///
+  /// Returns an element of a field array
+  ///
+  /// @tparam F field array of the layout
+  /// @param[in] index element index
+  ///
+  /// @return typename F::type element value in host order
+  ///
+  template <typename F>
+  typename F::type get(size_t index) const
+  {
+    return F::load(data_, index);
+  }
+
+  ///
+  /// Returns the first byte of a field or block
+  ///
+  /// @tparam B field or block of the layout
+  ///
+  /// @return const uint8_t* first byte
+  ///
+  template <typename B>
+  const uint8_t* at() const
+  {
+    return data_ + B::offset;
+  }
+
+  ///
+  /// Checks if a packet is large enough for a layout
+  ///
+  /// @tparam B last field or block that must be present
+  /// @param[in] packet packet to check
+  ///
+  /// @return bool true if the packet holds B
+  ///
+  template <typename B>
+  static bool fits(PacketView packet)
+  {
+    return packet.size() >= B::end;
+  }
+
+private:
+  /// First byte of the layout
+  const uint8_t* data_;
+};
+
+/// Views of the v1 packets
+typedef LayoutView<FrameLayoutV1> FrameViewV1;
+typedef LayoutView<ObjectLayoutV1> ObjectViewV1;
+typedef LayoutView<ObjectRecordLayoutV1> ObjectRecordViewV1;
+typedef LayoutView<TelemetryLayoutV1> TelemetryViewV1;
+
+}  // namespace hfl
+
+#endif  // PACKET_LAYOUT_H_
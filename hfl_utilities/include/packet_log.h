@@ -0,0 +1,159 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// @file packet_log.h
+///
+/// @brief This file defines the packet log file reader and writer.
+///
+/// Packet log format, all integers in host byte order:
+///
+///   magic    8 bytes  "HFLPKT01"
+///   records  until the end of the file, each:
+///     receive_time  uint64  kernel receive time, nanoseconds since epoch
+///     size          uint32  datagram size in bytes
+///     channel       uint16  packet_channel (frame, pdm, object, tele, slice)
+///     reserved      uint16  0
+///     data          size bytes, the raw datagram
+///
+#ifndef PACKET_LOG_H_
+#define PACKET_LOG_H_
+
+#include <hfl_packet.h>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+namespace hfl
+{
+class HflInterface;
+
+/// Packet log file magic, followed by the records
+const char PACKET_LOG_MAGIC[8] = { 'H', 'F', 'L', 'P', 'K', 'T', '0', '1' };
+
+///
+/// @brief Header preceding every packet in a log file, host byte order.
+///
+struct PacketRecordHeader
+{
+  /// Kernel receive time in nanoseconds since epoch, 0 if unknown
+  uint64_t receive_time;
+
+  /// Packet size in bytes
+  uint32_t size;
+
+  /// Sensor channel the packet arrived on
+  uint16_t channel;
+
+  /// Reserved, written as 0
+  uint16_t reserved;
+};
+
+///
+/// @brief Writes packets to a log file.
+///
+class PacketLogWriter
+{
+public:
+  ///
+  /// Opens a log file, truncating it
+  ///
+  /// @param[in] path log file path
+  ///
+  /// @return bool true if file opened
+  ///
+  bool open(const std::string& path);
+
+  ///
+  /// Appends a packet
+  ///
+  /// @param[in] channel channel the packet arrived on
+  /// @param[in] packet packet to write, its receive time is stored
+  ///
+  /// @return bool true if written
+  ///
+  bool write(packet_channel channel, PacketView packet);
+
+  ///
+  /// Flushes and closes the log file
+  ///
+  void close();
+
+private:
+  /// Log file
+  std::ofstream file_;
+};
+
+///
+/// @brief Reads packets from a log file.
+///
+class PacketLogReader
+{
+public:
+  ///
+  /// Opens a log file and checks its magic
+  ///
+  /// @param[in] path log file path
+  ///
+  /// @return bool true if file is a packet log
+  ///
+  bool open(const std::string& path);
+
+  ///
+  /// Reads the next packet
+  ///
+  /// @param[out] buffer packet bytes and receive time
+  /// @param[out] channel channel the packet arrived on
+  ///
+  /// @return bool true if a packet was read, false at the end of the log
+  ///
+  bool read(PacketBuffer& buffer, packet_channel& channel);
+
+  ///
+  /// Feeds all remaining packets to the camera's process functions
+  ///
+  /// @param[in] camera camera to process the packets
+  ///
+  /// @return size_t number of packets read
+  ///
+  size_t feed(HflInterface& camera);
+
+  ///
+  /// Returns to the first packet
+  ///
+  void rewind();
+
+private:
+  /// Log file
+  std::ifstream file_;
+};
+
+}  // namespace hfl
+#endif  // PACKET_LOG_H_
@@ -0,0 +1,217 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// @file packet_queue.h
+///
+/// @brief This file defines the single-producer/single-consumer packet queue.
+///
+#ifndef PACKET_QUEUE_H_
+#define PACKET_QUEUE_H_
+
+#include <hfl_packet.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace hfl
+{
+/// Cache line size used to keep producer and consumer indices apart
+const size_t CACHE_LINE_SIZE{ 64 };
+
+///
+/// @brief Bounded lock-free single-producer/single-consumer packet queue.
+///
+/// The queue owns its packet buffers. The producer claims free buffers,
+/// fills them in place and commits them; the consumer reads committed
+/// buffers in place and pops them. No packet is ever copied or allocated.
+///
+class PacketQueue
+{
+public:
+  ///
+  /// PacketQueue constructor
+  ///
+  /// @param capacity number of packet buffers, rounded up to a power of two
+  ///
+  explicit PacketQueue(size_t capacity)
+    : pool_(capacity), head_(0), tail_(0), overflow_count_(0), max_depth_(0)
+  {
+  }
+
+  ///
+  /// Returns the number of free buffers the producer may claim, up to count
+  ///
+  /// Producer side only.
+  ///
+  /// @param[in] count wanted number of buffers
+  ///
+  /// @return size_t number of contiguous free buffers starting at claim(0)
+  ///
+  size_t available(size_t count) const
+  {
+    size_t head = head_.load(std::memory_order_relaxed);
+    size_t free = pool_.capacity() - (head - tail_.load(std::memory_order_acquire));
+    return (count < free) ? count : free;
+  }
+
+  ///
+  /// Returns the i-th free buffer after the last committed one
+  ///
+  /// Producer side only, i must be lower than available().
+  ///
+  /// @param[in] i offset from the first free buffer
+  ///
+  /// @return PacketBuffer reference to fill
+  ///
+  PacketBuffer& claim(size_t i)
+  {
+    return pool_.at(head_.load(std::memory_order_relaxed) + i);
+  }
+
+  ///
+  /// Makes the first count claimed buffers visible to the consumer
+  ///
+  /// Producer side only.
+  ///
+  /// @param[in] count number of filled buffers
+  ///
+  void commit(size_t count)
+  {
+    size_t head = head_.load(std::memory_order_relaxed) + count;
+    head_.store(head, std::memory_order_release);
+    size_t depth = head - tail_.load(std::memory_order_relaxed);
+    if (depth > max_depth_.load(std::memory_order_relaxed))
+    {
+      max_depth_.store(depth, std::memory_order_relaxed);
+    }
+  }
+
+  ///
+  /// Records packets the producer had to drop because the queue was full
+  ///
+  /// Producer side only.
+  ///
+  /// @param[in] count number of dropped packets
+  ///
+  void overflow(size_t count)
+  {
+    overflow_count_.fetch_add(count, std::memory_order_relaxed);
+  }
+
+  ///
+  /// Returns the oldest committed buffer
+  ///
+  /// Consumer side only.
+  ///
+  /// @return PacketBuffer pointer or nullptr if the queue is empty
+  ///
+  const PacketBuffer* front() const
+  {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire))
+    {
+      return nullptr;
+    }
+    return &pool_.at(tail);
+  }
+
+  ///
+  /// Releases the oldest committed buffer back to the producer
+  ///
+  /// Consumer side only.
+  ///
+  void pop()
+  {
+    tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  ///
+  /// Returns the number of committed buffers waiting for the consumer
+  ///
+  /// @return size_t queue depth
+  ///
+  size_t depth() const
+  {
+    return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+  }
+
+  ///
+  /// Returns the highest queue depth seen so far
+  ///
+  /// @return size_t maximum queue depth
+  ///
+  size_t getMaxDepth() const
+  {
+    return max_depth_.load(std::memory_order_relaxed);
+  }
+
+  ///
+  /// Returns the number of packets dropped because the queue was full
+  ///
+  /// @return uint64_t overflow count
+  ///
+  uint64_t getOverflowCount() const
+  {
+    return overflow_count_.load(std::memory_order_relaxed);
+  }
+
+  ///
+  /// Returns the queue capacity
+  ///
+  /// @return size_t number of packet buffers
+  ///
+  size_t capacity() const
+  {
+    return pool_.capacity();
+  }
+
+private:
+  /// Packet buffers
+  PacketPool pool_;
+
+  /// Producer position, on its own cache line
+  std::atomic<size_t> head_;
+  char head_padding_[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+
+  /// Consumer position, on its own cache line
+  std::atomic<size_t> tail_;
+  char tail_padding_[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+
+  /// Dropped packet counter
+  std::atomic<uint64_t> overflow_count_;
+
+  /// Maximum queue depth
+  std::atomic<size_t> max_depth_;
+};
+
+}  // namespace hfl
+#endif  // PACKET_QUEUE_H_
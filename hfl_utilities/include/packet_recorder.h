@@ -0,0 +1,192 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// @file packet_recorder.h
+///
+/// @brief This file defines the raw packet recorder class.
+///
+#ifndef PACKET_RECORDER_H_
+#define PACKET_RECORDER_H_
+
+#include <hfl_packet.h>
+#include <packet_log.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace hfl
+{
+/// Default recorder block size in bytes
+const size_t RECORDER_BLOCK_SIZE{ 1 << 20 };
+/// Default number of recorder blocks
+const size_t RECORDER_BLOCKS{ 8 };
+/// Recorder block alignment in bytes
+const size_t RECORDER_ALIGNMENT{ 4096 };
+/// Milliseconds after which a partially filled block is written anyway
+const int RECORDER_FLUSH_INTERVAL{ 1000 };
+
+///
+/// @brief Appends raw datagrams to a packet log file.
+///
+/// Producers copy each datagram with its record header into the current
+/// block of a ring of large aligned blocks. Full blocks are handed to a
+/// writer thread, so recording costs one memcpy on the caller's thread.
+/// When the writer falls behind and no block is free, datagrams are
+/// dropped and counted instead of blocking the caller. The file format
+/// is the packet log format read by PacketLogReader.
+///
+class PacketRecorder
+{
+public:
+  ///
+  /// PacketRecorder constructor
+  ///
+  /// @param block_size size of one block in bytes
+  /// @param blocks number of blocks
+  ///
+  explicit PacketRecorder(size_t block_size = RECORDER_BLOCK_SIZE, size_t blocks = RECORDER_BLOCKS);
+
+  ///
+  /// PacketRecorder destructor, writes pending blocks and closes the file
+  ///
+  ~PacketRecorder();
+
+  ///
+  /// Creates the log file and starts the writer thread
+  ///
+  /// @param[in] path log file path
+  ///
+  /// @return bool true if recording started
+  ///
+  bool open(const std::string& path);
+
+  ///
+  /// Writes pending blocks, stops the writer thread and closes the file
+  ///
+  void close();
+
+  ///
+  /// Records a datagram, callable from any thread
+  ///
+  /// @param[in] channel channel the datagram arrived on
+  /// @param[in] packet datagram, stamped with the current time if it has no receive time
+  ///
+  /// @return bool true if recorded, false if not open or no block was free
+  ///
+  bool record(packet_channel channel, PacketView packet);
+
+  ///
+  /// Returns the number of recorded datagrams
+  ///
+  /// @return uint64_t recorded datagrams
+  ///
+  uint64_t getRecordedCount() const
+  {
+    return recorded_count_;
+  }
+
+  ///
+  /// Returns the number of datagrams dropped because no block was free
+  ///
+  /// @return uint64_t dropped datagrams
+  ///
+  uint64_t getDroppedCount() const
+  {
+    return dropped_count_;
+  }
+
+  ///
+  /// Returns the number of bytes written to the file
+  ///
+  /// @return uint64_t written bytes
+  ///
+  uint64_t getWrittenBytes() const
+  {
+    return written_bytes_;
+  }
+
+private:
+  /// Aligned block of records
+  struct Block
+  {
+    uint8_t* data;
+    size_t used;
+  };
+
+  /// Size of one block in bytes
+  size_t block_size_;
+
+  /// All blocks, allocated once
+  std::vector<Block> blocks_;
+
+  /// Block being filled by producers
+  size_t current_;
+
+  /// Blocks ready for producers
+  std::vector<size_t> free_;
+
+  /// Blocks waiting to be written, oldest first
+  std::deque<size_t> full_;
+
+  /// Guards the block lists
+  std::mutex mutex_;
+
+  /// Wakes the writer thread
+  std::condition_variable ready_;
+
+  /// Log file descriptor
+  int file_fd_;
+
+  /// True while recording
+  bool running_;
+
+  /// Writer thread
+  std::thread writer_thread_;
+
+  /// Counters
+  std::atomic<uint64_t> recorded_count_;
+  std::atomic<uint64_t> dropped_count_;
+  std::atomic<uint64_t> written_bytes_;
+
+  ///
+  /// Writer loop, writes full blocks and flushes idle partial blocks
+  ///
+  void writeLoop();
+};
+
+}  // namespace hfl
+#endif  // PACKET_RECORDER_H_
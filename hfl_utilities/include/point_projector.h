@@ -0,0 +1,118 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// @file point_projector.h
+///
+/// @brief This file defines the frame row point projector.
+///
+#ifndef POINT_PROJECTOR_H_
+#define POINT_PROJECTOR_H_
+
+#include <row_decoder.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hfl
+{
+/// Bytes of one projected point
+const size_t POINT_STEP{ 20 };
+/// Offsets of the point fields: x, y, z and intensity as float, return
+/// number and crosstalk, saturated and superimposed flags as uint8_t
+const size_t POINT_X_OFFSET{ 0 };
+const size_t POINT_Y_OFFSET{ 4 };
+const size_t POINT_Z_OFFSET{ 8 };
+const size_t POINT_INTENSITY_OFFSET{ 12 };
+const size_t POINT_RETURN_OFFSET{ 16 };
+const size_t POINT_CROSSTALK_OFFSET{ 17 };
+const size_t POINT_SATURATED_OFFSET{ 18 };
+const size_t POINT_SUPERIMPOSED_OFFSET{ 19 };
+
+///
+/// @brief Projects decoded frame rows into points.
+///
+/// Holds the unit ray of every pixel and scales it by the decoded range,
+/// so each row can be projected as soon as it is decoded instead of the
+/// whole frame at publish time. Points are written packed, POINT_STEP
+/// bytes each, both returns of a column next to each other.
+///
+class PointProjector
+{
+public:
+  ///
+  /// PointProjector constructor, all rays NaN until set
+  ///
+  /// @param rows number of rows per frame
+  /// @param columns number of columns per frame, at most ROW_COLUMNS
+  ///
+  PointProjector(size_t rows, size_t columns);
+
+  ///
+  /// Sets the ray of a pixel
+  ///
+  /// @param[in] row row index
+  /// @param[in] col column index
+  /// @param[in] x, y, z ray direction, a range of 1 m projects to this point
+  ///
+  void setRay(size_t row, size_t col, float x, float y, float z);
+
+  ///
+  /// Projects one decoded row
+  ///
+  /// @param[in] row row index
+  /// @param[in] ranges decoded ranges and intensities of the row
+  /// @param[in] flags decoded flags of the row, 0 or 255
+  /// @param[out] points 2 * columns points, no alignment required
+  ///
+  void projectRow(size_t row, const DecodedRow& ranges, const DecodedFlags& flags, uint8_t* points) const;
+
+  ///
+  /// Returns the size of the points of one row in bytes
+  ///
+  /// @return size_t row step
+  ///
+  size_t getRowStep() const
+  {
+    return columns_ * 2 * POINT_STEP;
+  }
+
+private:
+  /// Frame size
+  size_t rows_;
+  size_t columns_;
+
+  /// Rays, row major, x, y and z of each pixel
+  std::vector<float> rays_;
+};
+
+}  // namespace hfl
+#endif  // POINT_PROJECTOR_H_
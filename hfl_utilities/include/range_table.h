@@ -0,0 +1,168 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// @file range_table.h
+///
+/// @brief This file defines the double buffered range conversion table.
+///
+#ifndef RANGE_TABLE_H_
+#define RANGE_TABLE_H_
+
+#include <row_decoder.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace hfl
+{
+///
+/// @brief Raw range word to meters lookup table with the global offset,
+/// scale and no-return cutoff baked in.
+///
+/// Two tables are kept. setOffset() rebuilds the one not in use and then
+/// publishes it with an atomic swap, so decoding never waits for a
+/// rebuild. A Reader pins the published table while a row is decoded; a
+/// rebuild waits for readers of the table it is about to overwrite.
+///
+class RangeTable
+{
+public:
+  ///
+  /// RangeTable constructor
+  ///
+  /// @param offset raw range offset (meters * 256)
+  ///
+  explicit RangeTable(float offset = 0.0f);
+
+  RangeTable(const RangeTable&) = delete;
+  RangeTable& operator=(const RangeTable&) = delete;
+
+  ///
+  /// Rebuilds the table for a new offset, safe to call while decoding
+  ///
+  /// @param[in] offset raw range offset (meters * 256)
+  ///
+  void setOffset(float offset);
+
+  ///
+  /// Returns the offset of the published table
+  ///
+  /// @return float raw range offset (meters * 256)
+  ///
+  float getOffset() const;
+
+  ///
+  /// Converts one raw range word without a table
+  ///
+  /// @param[in] offset raw range offset (meters * 256)
+  /// @param[in] word raw range word
+  ///
+  /// @return float meters, NaN beyond ROW_RANGE_CUTOFF
+  ///
+  static float convert(float offset, uint16_t word);
+
+  ///
+  /// @brief Pins the published table for the lifetime of the reader.
+  ///
+  class Reader
+  {
+  public:
+    ///
+    /// Reader constructor
+    ///
+    /// @param table table to pin
+    ///
+    explicit Reader(const RangeTable& table);
+
+    ///
+    /// Reader destructor, releases the table
+    ///
+    ~Reader();
+
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    ///
+    /// Returns the pinned conversion
+    ///
+    /// @return const RangeConversion& offset and table
+    ///
+    const RangeConversion& get() const
+    {
+      return table_.buffers_[index_].conversion;
+    }
+
+  private:
+    /// Pinned table
+    const RangeTable& table_;
+
+    /// Index of the pinned buffer
+    size_t index_;
+  };
+
+private:
+  /// One of the two tables
+  struct Buffer
+  {
+    /// Meters per raw range word
+    std::vector<float> range;
+
+    /// Offset and pointer to range
+    RangeConversion conversion;
+
+    /// Number of readers using this buffer
+    mutable std::atomic<uint32_t> readers;
+  };
+
+  ///
+  /// Fills a buffer for an offset
+  ///
+  /// @param[in] buffer buffer to fill
+  /// @param[in] offset raw range offset (meters * 256)
+  ///
+  static void fill(Buffer& buffer, float offset);
+
+  /// Both tables
+  Buffer buffers_[2];
+
+  /// Index of the published table
+  std::atomic<size_t> current_;
+
+  /// Serializes rebuilds
+  std::mutex write_mutex_;
+};
+
+}  // namespace hfl
+
+#endif  // RANGE_TABLE_H_
@@ -0,0 +1,233 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// @file row_decoder.h
+///
+/// @brief This file defines the vectorized HFL110DCU frame row decoder.
+///
+#ifndef ROW_DECODER_H_
+#define ROW_DECODER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace hfl
+{
+/// Pixel columns per frame row
+const size_t ROW_COLUMNS{ 128 };
+/// Offset of the interleaved range words of both returns in the row data
+const size_t ROW_RANGE_OFFSET{ 0 };
+/// Offset of the interleaved intensity words of both returns in the row data
+const size_t ROW_INTENSITY_OFFSET{ 512 };
+/// Size of the range and intensity data of a row in bytes
+const size_t ROW_DATA_SIZE{ 1024 };
+/// Offset of the classification flag bytes in the row data
+const size_t ROW_FLAG_OFFSET{ 1152 };
+/// Size of one bit-packed flag plane of a row in bytes
+const size_t ROW_FLAG_PLANE_SIZE{ ROW_COLUMNS / 8 };
+/// Bits of the classification flag byte
+const uint8_t FLAG_CROSSTALK{ 1 << 0 };
+const uint8_t FLAG_SATURATED{ 1 << 1 };
+const uint8_t FLAG_SUPERIMPOSED{ 1 << 3 };
+const uint8_t FLAG_CROSSTALK_2{ 1 << 4 };
+const uint8_t FLAG_SATURATED_2{ 1 << 5 };
+const uint8_t FLAG_SUPERIMPOSED_2{ 1 << 7 };
+/// Scale of raw range words to meters
+const float ROW_RANGE_SCALE{ 1.0f / 256.0f };
+/// Ranges beyond this distance in meters are no return (NaN)
+const float ROW_RANGE_CUTOFF{ 49.0f };
+/// Number of raw range words
+const size_t RANGE_TABLE_SIZE{ 65536 };
+
+/// Instruction sets of the row decode kernels
+enum row_decoder_isa
+{
+  isa_scalar = 0,
+  isa_sse41,
+  isa_avx2
+};
+
+///
+/// @brief Conversion of raw range words to meters.
+///
+struct RangeConversion
+{
+  /// Raw range offset (meters * 256)
+  float offset{ 0.0f };
+
+  /// Meters of every raw range word, RANGE_TABLE_SIZE entries with offset,
+  /// scale and cutoff applied
+  const float* table{ nullptr };
+};
+
+///
+/// @brief Destination of one decoded frame row, ROW_COLUMNS elements each.
+///
+struct DecodedRow
+{
+  /// Ranges of the first and second return in meters
+  float* range_1{ nullptr };
+  float* range_2{ nullptr };
+
+  /// Intensities of the first and second return
+  uint16_t* intensity_1{ nullptr };
+  uint16_t* intensity_2{ nullptr };
+};
+
+///
+/// @brief Destination of the classification flags of one frame row, ROW_COLUMNS
+/// elements each, 255 where the flag is set and 0 otherwise.
+///
+struct DecodedFlags
+{
+  /// Flags of the first return
+  uint8_t* crosstalk{ nullptr };
+  uint8_t* saturated{ nullptr };
+  uint8_t* superimposed{ nullptr };
+
+  /// Flags of the second return
+  uint8_t* crosstalk_2{ nullptr };
+  uint8_t* saturated_2{ nullptr };
+  uint8_t* superimposed_2{ nullptr };
+};
+
+///
+/// @brief Decodes the range and intensity words and the flags of a frame row.
+///
+/// Byte-swaps and deinterleaves both returns, converts ranges to meters as
+/// (offset + range) * ROW_RANGE_SCALE in single precision and sets ranges
+/// beyond ROW_RANGE_CUTOFF to NaN. The scalar kernel looks ranges up in the
+/// conversion table, the vector kernels compute them, which is faster than
+/// a gather. The kernel is chosen once at construction from the instruction
+/// sets the CPU supports; all kernels produce bit identical results.
+///
+class RowDecoder
+{
+public:
+  ///
+  /// RowDecoder constructor, selects the fastest supported kernel
+  ///
+  RowDecoder();
+
+  ///
+  /// RowDecoder constructor
+  ///
+  /// @param isa requested kernel, falls back to scalar if not supported
+  ///
+  explicit RowDecoder(row_decoder_isa isa);
+
+  ///
+  /// Decodes one row
+  ///
+  /// @param[in] data row data, ROW_DATA_SIZE bytes, no alignment required
+  /// @param[in] range range conversion, see RangeTable
+  /// @param[out] row destination planes, no alignment required
+  ///
+  void decode(const uint8_t* data, const RangeConversion& range, const DecodedRow& row) const
+  {
+    decode_(data, range, row);
+  }
+
+  ///
+  /// Expands the classification flags of one row into one image per flag
+  ///
+  /// @param[in] flags ROW_COLUMNS flag bytes, no alignment required
+  /// @param[out] planes destination planes, no alignment required
+  ///
+  void unpackFlags(const uint8_t* flags, const DecodedFlags& planes) const
+  {
+    unpack_flags_(flags, planes);
+  }
+
+  ///
+  /// Packs the classification flags of one row into bit planes
+  ///
+  /// Plane b holds flag bit b of all columns, bit c % 8 of byte c / 8 set
+  /// if column c has the flag, so consumers can test bits directly.
+  ///
+  /// @param[in] flags ROW_COLUMNS flag bytes, no alignment required
+  /// @param[out] bits 8 planes of ROW_FLAG_PLANE_SIZE bytes each
+  ///
+  void packFlags(const uint8_t* flags, uint8_t* bits) const
+  {
+    pack_flags_(flags, bits);
+  }
+
+  ///
+  /// Returns the selected kernel
+  ///
+  /// @return row_decoder_isa instruction set
+  ///
+  row_decoder_isa getIsa() const
+  {
+    return isa_;
+  }
+
+  ///
+  /// Checks if the CPU supports a kernel
+  ///
+  /// @param[in] isa instruction set
+  ///
+  /// @return bool true if supported
+  ///
+  static bool isSupported(row_decoder_isa isa);
+
+  ///
+  /// Returns the name of a kernel
+  ///
+  /// @param[in] isa instruction set
+  ///
+  /// @return const char* name
+  ///
+  static const char* getIsaName(row_decoder_isa isa);
+
+private:
+  /// Row decode kernel
+  typedef void (*DecodeKernel)(const uint8_t* data, const RangeConversion& range, const DecodedRow& row);
+
+  /// Flag unpack kernel
+  typedef void (*UnpackFlagsKernel)(const uint8_t* flags, const DecodedFlags& planes);
+
+  /// Flag pack kernel
+  typedef void (*PackFlagsKernel)(const uint8_t* flags, uint8_t* bits);
+
+  /// Selected kernels
+  DecodeKernel decode_;
+  UnpackFlagsKernel unpack_flags_;
+  PackFlagsKernel pack_flags_;
+
+  /// Instruction set of the selected kernel
+  row_decoder_isa isa_;
+};
+
+}  // namespace hfl
+
+#endif  // ROW_DECODER_H_
@@ -0,0 +1,180 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// @file stage_profiler.h
+///
+/// @brief This file defines the processing stage profiler.
+///
+#ifndef STAGE_PROFILER_H_
+#define STAGE_PROFILER_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hfl
+{
+///
+/// @brief Accumulates time spent in named processing stages.
+///
+class StageProfiler
+{
+public:
+  ///
+  /// StageProfiler constructor
+  ///
+  /// @param stages stage names, stage i is identified by its index
+  ///
+  explicit StageProfiler(const std::vector<std::string>& stages);
+
+  ///
+  /// Adds one measurement to a stage
+  ///
+  /// @param[in] stage stage index
+  /// @param[in] nanoseconds time spent
+  ///
+  void add(size_t stage, uint64_t nanoseconds);
+
+  ///
+  /// Clears all measurements
+  ///
+  void reset();
+
+  ///
+  /// Returns the number of stages
+  ///
+  /// @return size_t stage count
+  ///
+  size_t size() const
+  {
+    return names_.size();
+  }
+
+  ///
+  /// Returns the name of a stage
+  ///
+  /// @param[in] stage stage index
+  ///
+  /// @return std::string stage name
+  ///
+  const std::string& getName(size_t stage) const
+  {
+    return names_[stage];
+  }
+
+  ///
+  /// Returns the total time spent in a stage
+  ///
+  /// @param[in] stage stage index
+  ///
+  /// @return uint64_t nanoseconds
+  ///
+  uint64_t getTotal(size_t stage) const
+  {
+    return totals_[stage];
+  }
+
+  ///
+  /// Returns the number of measurements of a stage
+  ///
+  /// @param[in] stage stage index
+  ///
+  /// @return uint64_t measurements
+  ///
+  uint64_t getCount(size_t stage) const
+  {
+    return counts_[stage];
+  }
+
+  ///
+  /// Returns a monotonic timestamp
+  ///
+  /// @return uint64_t nanoseconds
+  ///
+  static uint64_t now()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+private:
+  /// Stage names
+  std::vector<std::string> names_;
+
+  /// Accumulated nanoseconds per stage
+  std::vector<uint64_t> totals_;
+
+  /// Measurements per stage
+  std::vector<uint64_t> counts_;
+};
+
+///
+/// @brief Measures consecutive stages, does nothing without a profiler.
+///
+class StageTimer
+{
+public:
+  ///
+  /// StageTimer constructor, starts the first stage
+  ///
+  /// @param profiler profiler to add to, may be null
+  ///
+  explicit StageTimer(StageProfiler* profiler)
+    : profiler_(profiler), start_(profiler ? StageProfiler::now() : 0)
+  {
+  }
+
+  ///
+  /// Ends the current stage and starts the next one
+  ///
+  /// @param[in] stage index of the stage that just ended
+  ///
+  void lap(size_t stage)
+  {
+    if (profiler_)
+    {
+      uint64_t now = StageProfiler::now();
+      profiler_->add(stage, now - start_);
+      start_ = now;
+    }
+  }
+
+private:
+  /// Profiler, null if profiling is disabled
+  StageProfiler* profiler_;
+
+  /// Start of the current stage
+  uint64_t start_;
+};
+
+}  // namespace hfl
+#endif  // STAGE_PROFILER_H_
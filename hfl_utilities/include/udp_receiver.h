@@ -0,0 +1,219 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// @file udp_receiver.h
+///
+/// @brief This file defines the native UDP receiver class.
+///
+#ifndef UDP_RECEIVER_H_
+#define UDP_RECEIVER_H_
+
+#include <hfl_packet.h>
+#include <packet_queue.h>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <time.h>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace hfl
+{
+/// Maximum number of datagrams read by a single recvmmsg call
+const unsigned int UDP_BATCH_SIZE{ 32 };
+/// Number of packet buffers in the receive queue
+const size_t UDP_QUEUE_SIZE{ 256 };
+/// Socket poll timeout in milliseconds
+const int UDP_POLL_TIMEOUT{ 100 };
+/// Ancillary data buffer size per datagram, holds the receive timestamp
+const size_t UDP_CONTROL_SIZE{ 64 };
+
+///
+/// @brief Receives HFL datagrams directly from one sensor socket.
+///
+/// A receive thread reads the socket in recvmmsg batches straight into
+/// the buffers of a lock-free SPSC queue. A consumer thread drains the
+/// queue and hands every datagram to the registered callback, so a slow
+/// consumer on one port never delays the others.
+///
+class UdpReceiver
+{
+public:
+  /// Datagram callback, called with a view of the datagram which is only
+  /// valid for the duration of the call
+  using Callback = std::function<void(PacketView data)>;
+
+  ///
+  /// UdpReceiver constructor
+  ///
+  /// @param[in] source_address IPv4 address datagrams must originate from
+  /// @param[in] port UDP port number
+  /// @param[in] callback function called for every received datagram
+  /// @param[in] queue_size number of datagrams buffered between the threads
+  ///
+  UdpReceiver(const std::string& source_address, uint16_t port,
+              const Callback& callback, size_t queue_size = UDP_QUEUE_SIZE);
+
+  ///
+  /// UdpReceiver destructor, stops the threads and closes the socket
+  ///
+  ~UdpReceiver();
+
+  ///
+  /// Opens and binds the socket
+  ///
+  /// @param[in] local_address local IPv4 address to bind to
+  ///
+  /// @return bool true if socket created
+  ///
+  bool open(const std::string& local_address);
+
+  ///
+  /// Starts the receive and consumer threads
+  ///
+  /// @return bool true if threads started
+  ///
+  bool start();
+
+  ///
+  /// Stops the receive and consumer threads
+  ///
+  void stop();
+
+  ///
+  /// Returns the UDP port number
+  ///
+  /// @return uint16_t port
+  ///
+  uint16_t getPort() const
+  {
+    return port_;
+  }
+
+  ///
+  /// Returns the number of datagrams queued for the consumer
+  ///
+  /// @return uint64_t received datagrams
+  ///
+  uint64_t getReceivedCount() const
+  {
+    return received_count_;
+  }
+
+  ///
+  /// Returns the number of datagrams dropped (wrong source or truncated)
+  ///
+  /// @return uint64_t dropped datagrams
+  ///
+  uint64_t getDroppedCount() const
+  {
+    return dropped_count_;
+  }
+
+  ///
+  /// Returns the receive queue
+  ///
+  /// @return PacketQueue const reference for depth and overflow counters
+  ///
+  const PacketQueue& getQueue() const
+  {
+    return queue_;
+  }
+
+private:
+  /// Expected datagram source address
+  in_addr_t source_address_;
+
+  /// UDP port number
+  uint16_t port_;
+
+  /// Datagram callback
+  Callback callback_;
+
+  /// Socket file descriptor
+  int socket_fd_;
+
+  /// Consumer wake up event file descriptor
+  int event_fd_;
+
+  /// Hand-off queue between receive and consumer threads
+  PacketQueue queue_;
+
+  /// Scratch buffer used to drain the socket while the queue is full
+  PacketBuffer overflow_buffer_;
+
+  /// Receive thread
+  std::thread receive_thread_;
+
+  /// Consumer thread
+  std::thread consumer_thread_;
+
+  /// Threads running flag
+  std::atomic<bool> running_;
+
+  /// Received datagram counter
+  std::atomic<uint64_t> received_count_;
+
+  /// Dropped datagram counter
+  std::atomic<uint64_t> dropped_count_;
+
+  ///
+  /// Receive loop, polls the socket and drains it in batches
+  ///
+  void receiveLoop();
+
+  ///
+  /// Reads all pending datagrams into the queue
+  ///
+  void receiveBatch();
+
+  ///
+  /// Extracts the kernel receive timestamp of a datagram
+  ///
+  /// @param[in] message received message header with ancillary data
+  /// @param[in] fallback time used if the datagram carries no timestamp
+  ///
+  /// @return uint64_t receive time in nanoseconds since epoch
+  ///
+  static uint64_t receiveTime(msghdr& message, const timespec& fallback);
+
+  ///
+  /// Consumer loop, hands queued datagrams to the callback
+  ///
+  void consumeLoop();
+};
+
+}  // namespace hfl
+#endif  // UDP_RECEIVER_H_
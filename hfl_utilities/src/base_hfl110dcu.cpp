@@ -77,6 +77,7 @@ bool BaseHFL110DCU::setGlobalRangeOffset(double offset)
 {
   try {
     global_offset_ = offset * 256;
+    range_table_.setOffset(float(global_offset_));
     return true;
   } catch (const std::exception& e) {
     return false;
@@ -142,4 +143,24 @@ bool BaseHFL110DCU::setExtrinsicTranslatationZ(double z)
     return false;
   }
 }
+
+bool BaseHFL110DCU::setExtrinsicsReconfigured(bool extrinsics_reconfigured)
+{
+  try {
+    extrinsics_reconfigured_ = extrinsics_reconfigured;
+    return true;
+  } catch (const std::exception& e) {
+    return false;
+  }
+}
+
+bool BaseHFL110DCU::setTimeOffset(double offset)
+{
+  try {
+    time_offset_ = offset;
+    return true;
+  } catch (const std::exception& e) {
+    return false;
+  }
+}
 }  // namespace hfl
@@ -0,0 +1,73 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// @file calibration_monitor.cpp
+///
+/// @brief This file implements the sensor calibration change detector.
+///
+#include <calibration_monitor.h>
+
+namespace hfl
+{
+namespace
+{
+/// 64 bit FNV-1a parameters
+const uint64_t FNV_OFFSET_BASIS{ 14695981039346656037ULL };
+const uint64_t FNV_PRIME{ 1099511628211ULL };
+}  // namespace
+
+CalibrationMonitor::CalibrationMonitor() : hash_(0), epoch_(0)
+{
+}
+
+bool CalibrationMonitor::update(const uint8_t* data, size_t size)
+{
+  uint64_t block_hash = hash(data, size);
+  if (epoch_ > 0 && block_hash == hash_)
+  {
+    return false;
+  }
+  hash_ = block_hash;
+  epoch_ += 1;
+  return true;
+}
+
+uint64_t CalibrationMonitor::hash(const uint8_t* data, size_t size)
+{
+  uint64_t result = FNV_OFFSET_BASIS;
+  for (size_t i = 0; i < size; i += 1)
+  {
+    result = (result ^ data[i]) * FNV_PRIME;
+  }
+  return result;
+}
+
+}  // namespace hfl
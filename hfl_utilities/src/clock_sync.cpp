@@ -0,0 +1,160 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// @file clock_sync.cpp
+///
+/// @brief This file implements the sensor to host clock synchronization class.
+///
+#include <clock_sync.h>
+
+#include <cmath>
+#include <deque>
+#include <vector>
+
+namespace hfl
+{
+ClockSync::ClockSync(double tick, size_t window, double bucket)
+  : tick_(tick)
+  , window_((window < 1) ? 1 : window)
+  , bucket_duration_(bucket)
+  , reset_count_(0)
+{
+  reset();
+}
+
+void ClockSync::reset()
+{
+  started_ = false;
+  origin_ = 0;
+  bucket_start_ = 0.0;
+  bucket_min_ = { 0.0, 0.0 };
+  minima_.clear();
+  intercept_ = 0.0;
+  drift_ = 0.0;
+  latest_ = 0.0;
+}
+
+double ClockSync::toSeconds(uint64_t sensor_ticks) const
+{
+  return static_cast<double>(static_cast<int64_t>(sensor_ticks - origin_)) * tick_;
+}
+
+void ClockSync::addSample(uint64_t sensor_ticks, double host_time)
+{
+  if (started_)
+  {
+    // Restart on clock jumps, e.g. after a sensor reboot
+    double predicted = toHost(sensor_ticks);
+    if (std::fabs(host_time - predicted) > CLOCK_SYNC_RESET)
+    {
+      reset();
+      reset_count_ += 1;
+    }
+  }
+  if (!started_)
+  {
+    started_ = true;
+    origin_ = sensor_ticks;
+    bucket_start_ = host_time;
+    bucket_min_ = { 0.0, host_time };
+    fit();
+    return;
+  }
+
+  Sample sample = { toSeconds(sensor_ticks), 0.0 };
+  sample.offset = host_time - sample.sensor;
+  latest_ = sample.sensor;
+
+  if (host_time - bucket_start_ >= bucket_duration_)
+  {
+    // Close the bucket and start a new one with this sample
+    minima_.push_back(bucket_min_);
+    if (minima_.size() > window_)
+    {
+      minima_.pop_front();
+    }
+    bucket_start_ = host_time;
+    bucket_min_ = sample;
+    fit();
+  }
+  else if (sample.offset < bucket_min_.offset)
+  {
+    // Less delayed than any sample so far in this bucket
+    bucket_min_ = sample;
+    if (minima_.size() < 2)
+    {
+      fit();
+    }
+  }
+}
+
+double ClockSync::toHost(uint64_t sensor_ticks) const
+{
+  if (!started_)
+  {
+    return 0.0;
+  }
+  double sensor = toSeconds(sensor_ticks);
+  return sensor + intercept_ + drift_ * sensor;
+}
+
+void ClockSync::fit()
+{
+  // The open bucket has seen few samples, only use it until two buckets closed
+  std::vector<Sample> samples(minima_.begin(), minima_.end());
+  if (samples.size() < 2)
+  {
+    samples.push_back(bucket_min_);
+  }
+
+  double mean_x = 0.0;
+  double mean_y = 0.0;
+  for (const Sample& sample : samples)
+  {
+    mean_x += sample.sensor;
+    mean_y += sample.offset;
+  }
+  mean_x /= samples.size();
+  mean_y /= samples.size();
+
+  double sxx = 0.0;
+  double sxy = 0.0;
+  for (const Sample& sample : samples)
+  {
+    sxx += (sample.sensor - mean_x) * (sample.sensor - mean_x);
+    sxy += (sample.sensor - mean_x) * (sample.offset - mean_y);
+  }
+
+  // A single bucket only gives the offset
+  drift_ = (sxx > 0.0) ? sxy / sxx : 0.0;
+  intercept_ = mean_y - drift_ * mean_x;
+}
+
+}  // namespace hfl
@@ -0,0 +1,364 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// @file depth_codec.cpp
+///
+/// @brief This file implements the lossless depth and intensity image codec.
+///
+#include <depth_codec.h>
+
+#include <row_decoder.h>
+
+#include <cmath>
+#include <cstring>
+
+namespace hfl
+{
+namespace
+{
+/// Header: magic, version, format, rows and columns, little endian
+const uint8_t CODEC_MAGIC[4] = { 'H', 'F', 'L', 'Z' };
+const uint8_t CODEC_VERSION{ 1 };
+
+/// Token tags, the low two bits of every token
+enum codec_tag
+{
+  /// Residual of one pixel, zigzag coded
+  tag_residual = 0,
+  /// Run of pixels with zero residual
+  tag_zero_run = 1,
+  /// Run of no return pixels
+  tag_nan_run = 2,
+  /// Range stored verbatim in the four bytes after the token
+  tag_verbatim = 3
+};
+
+/// Largest token: a verbatim range, one tag byte and four bytes of range
+const size_t MAX_PIXEL_SIZE{ 5 };
+
+/// Bits of the no return ranges the decoder writes
+uint32_t noReturnBits()
+{
+  float no_return = NAN;
+  uint32_t bits;
+  memcpy(&bits, &no_return, sizeof(bits));
+  return bits;
+}
+
+/// Writes a variable length integer, 7 bits per byte, low bits first
+inline uint8_t* putVarint(uint8_t* out, uint32_t value)
+{
+  while (value >= 0x80)
+  {
+    *out++ = uint8_t(value) | 0x80;
+    value >>= 7;
+  }
+  *out++ = uint8_t(value);
+  return out;
+}
+
+/// Reads a variable length integer, false if it runs past the end
+inline bool getVarint(const uint8_t*& in, const uint8_t* end, uint32_t& value)
+{
+  value = 0;
+  for (int shift = 0; shift < 35 && in < end; shift += 7)
+  {
+    uint8_t byte = *in++;
+    value |= uint32_t(byte & 0x7f) << shift;
+    if (!(byte & 0x80))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+inline void putWord32(uint8_t* out, uint32_t value)
+{
+  for (int i = 0; i < 4; i += 1)
+  {
+    out[i] = uint8_t(value >> (8 * i));
+  }
+}
+
+inline uint32_t getWord32(const uint8_t* in)
+{
+  return uint32_t(in[0]) | uint32_t(in[1]) << 8 | uint32_t(in[2]) << 16 | uint32_t(in[3]) << 24;
+}
+
+/// Splits an image into words, no returns and verbatim ranges
+struct RangePixels
+{
+  const float* ranges;
+  uint32_t no_return;
+
+  /// Returns the tag of a pixel, its word if it is a residual
+  codec_tag classify(size_t i, int32_t& word) const
+  {
+    float range = ranges[i];
+    uint32_t bits;
+    memcpy(&bits, &range, sizeof(bits));
+    if (bits == no_return)
+    {
+      return tag_nan_run;
+    }
+    // Fixed point if scaling the word back gives the same bits, exact below 2^24
+    if (std::fabs(range) < 65536.0f)
+    {
+      word = int32_t(std::lrint(range * 256.0f));
+      float decoded = float(word) * ROW_RANGE_SCALE;
+      uint32_t decoded_bits;
+      memcpy(&decoded_bits, &decoded, sizeof(decoded_bits));
+      if (decoded_bits == bits)
+      {
+        return tag_residual;
+      }
+    }
+    return tag_verbatim;
+  }
+
+  uint32_t verbatim(size_t i) const
+  {
+    uint32_t bits;
+    memcpy(&bits, &ranges[i], sizeof(bits));
+    return bits;
+  }
+};
+
+/// Every pixel of a word image is a residual
+struct WordPixels
+{
+  const uint16_t* words;
+
+  codec_tag classify(size_t i, int32_t& word) const
+  {
+    word = words[i];
+    return tag_residual;
+  }
+
+  uint32_t verbatim(size_t) const
+  {
+    return 0;
+  }
+};
+
+/// Writes a pending run
+inline uint8_t* flushRun(uint8_t* out, codec_tag tag, uint32_t& length)
+{
+  if (length > 0)
+  {
+    out = putVarint(out, (length - 1) << 2 | tag);
+    length = 0;
+  }
+  return out;
+}
+
+/// Returns the prediction of a pixel from the words already coded
+inline int32_t predict(const std::vector<int32_t>& words, uint32_t row, uint32_t col)
+{
+  if (row > 0)
+  {
+    return words[col];
+  }
+  return col > 0 ? words[col - 1] : 0;
+}
+
+template <typename Pixels>
+void encodePixels(const Pixels& pixels, depth_codec_format format, uint32_t rows, uint32_t columns,
+                  std::vector<uint8_t>& out)
+{
+  // Sized for the worst case once, trimmed at the end
+  out.resize(DEPTH_CODEC_HEADER_SIZE + size_t(rows) * columns * MAX_PIXEL_SIZE);
+  memcpy(&out[0], CODEC_MAGIC, sizeof(CODEC_MAGIC));
+  out[4] = CODEC_VERSION;
+  out[5] = uint8_t(format);
+  putWord32(&out[6], rows);
+  putWord32(&out[10], columns);
+  uint8_t* next = &out[DEPTH_CODEC_HEADER_SIZE];
+
+  // Last word of each column, the row above once past the first row
+  std::vector<int32_t> words(columns, 0);
+  codec_tag run_tag = tag_zero_run;
+  uint32_t run_length = 0;
+  size_t i = 0;
+  for (uint32_t row = 0; row < rows; row += 1)
+  {
+    for (uint32_t col = 0; col < columns; col += 1, i += 1)
+    {
+      int32_t word = 0;
+      codec_tag tag = pixels.classify(i, word);
+      if (tag == tag_residual)
+      {
+        int32_t residual = word - predict(words, row, col);
+        words[col] = word;
+        tag = residual == 0 ? tag_zero_run : tag_residual;
+        if (tag == tag_residual)
+        {
+          next = flushRun(next, run_tag, run_length);
+          uint32_t zigzag = (uint32_t(residual) << 1) ^ uint32_t(residual >> 31);
+          next = putVarint(next, zigzag << 2 | tag_residual);
+          continue;
+        }
+      }
+      if (tag == tag_verbatim)
+      {
+        next = flushRun(next, run_tag, run_length);
+        *next++ = tag_verbatim;
+        putWord32(next, pixels.verbatim(i));
+        next += 4;
+        continue;
+      }
+      // Zero residual or no return, extend the run
+      if (tag != run_tag)
+      {
+        next = flushRun(next, run_tag, run_length);
+        run_tag = tag;
+      }
+      run_length += 1;
+    }
+  }
+  next = flushRun(next, run_tag, run_length);
+  out.resize(next - &out[0]);
+}
+}  // namespace
+
+void DepthCodec::encode(const float* ranges, uint32_t rows, uint32_t columns, std::vector<uint8_t>& out)
+{
+  RangePixels pixels = { ranges, noReturnBits() };
+  encodePixels(pixels, depth_codec_range, rows, columns, out);
+}
+
+void DepthCodec::encode(const uint16_t* words, uint32_t rows, uint32_t columns, std::vector<uint8_t>& out)
+{
+  WordPixels pixels = { words };
+  encodePixels(pixels, depth_codec_word, rows, columns, out);
+}
+
+bool DepthCodec::decode(const uint8_t* data, size_t size, depth_codec_format& format, uint32_t& rows,
+                        uint32_t& columns, std::vector<uint8_t>& image)
+{
+  if (size < DEPTH_CODEC_HEADER_SIZE || memcmp(data, CODEC_MAGIC, sizeof(CODEC_MAGIC)) != 0 ||
+      data[4] != CODEC_VERSION || data[5] > depth_codec_word)
+  {
+    return false;
+  }
+  format = depth_codec_format(data[5]);
+  rows = getWord32(&data[6]);
+  columns = getWord32(&data[10]);
+  // Runs make the pixel count independent of the data size, cap it before allocating
+  uint64_t count = uint64_t(rows) * columns;
+  if (count > DEPTH_CODEC_MAX_PIXELS || columns > DEPTH_CODEC_MAX_PIXELS)
+  {
+    return false;
+  }
+  bool ranges = format == depth_codec_range;
+  image.resize(count * (ranges ? sizeof(float) : sizeof(uint16_t)));
+
+  const uint8_t* in = data + DEPTH_CODEC_HEADER_SIZE;
+  const uint8_t* end = data + size;
+  uint32_t no_return = noReturnBits();
+  std::vector<int32_t> words(columns, 0);
+  uint32_t run_length = 0;
+  codec_tag run_tag = tag_zero_run;
+  size_t i = 0;
+  for (uint32_t row = 0; row < rows; row += 1)
+  {
+    for (uint32_t col = 0; col < columns; col += 1, i += 1)
+    {
+      codec_tag tag = run_tag;
+      int32_t residual = 0;
+      if (run_length > 0)
+      {
+        run_length -= 1;
+      }
+      else
+      {
+        uint32_t token;
+        if (!getVarint(in, end, token))
+        {
+          return false;
+        }
+        tag = codec_tag(token & 3);
+        if (tag == tag_residual)
+        {
+          uint32_t zigzag = token >> 2;
+          residual = int32_t(zigzag >> 1) ^ -int32_t(zigzag & 1);
+        }
+        else if (tag == tag_verbatim)
+        {
+          if (!ranges || end - in < 4)
+          {
+            return false;
+          }
+        }
+        else
+        {
+          if (tag == tag_nan_run && !ranges)
+          {
+            return false;
+          }
+          run_tag = tag;
+          run_length = token >> 2;
+        }
+      }
+
+      uint32_t bits;
+      if (tag == tag_verbatim)
+      {
+        bits = getWord32(in);
+        in += 4;
+      }
+      else if (tag == tag_nan_run)
+      {
+        bits = no_return;
+      }
+      else
+      {
+        // Residuals and zero runs add to the prediction
+        int32_t word = int32_t(uint32_t(predict(words, row, col)) + uint32_t(residual));
+        words[col] = word;
+        if (!ranges)
+        {
+          uint16_t value = uint16_t(word);
+          memcpy(&image[i * sizeof(value)], &value, sizeof(value));
+          continue;
+        }
+        float range = float(word) * ROW_RANGE_SCALE;
+        memcpy(&bits, &range, sizeof(bits));
+      }
+      memcpy(&image[i * sizeof(bits)], &bits, sizeof(bits));
+    }
+  }
+  // Runs must end with the image and every byte must be used
+  return run_length == 0 && in == end;
+}
+
+}  // namespace hfl
@@ -0,0 +1,117 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// @file frame_buffer.cpp
+///
+/// @brief This file implements the frame plane buffer class.
+///
+#include <frame_buffer.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace hfl
+{
+FrameBuffer::FrameBuffer(uint16_t rows, uint16_t columns, bool allocate)
+  : rows_(rows)
+  , columns_(columns)
+  , size_(0)
+  , data_(nullptr)
+{
+  // Planes back to back, each starting on a cache line
+  for (int plane = 0; plane < plane_count; plane += 1)
+  {
+    offsets_[plane] = size_;
+    size_t plane_size = size_t(rows_) * getStep(frame_plane(plane));
+    size_ += (plane_size + FRAME_BUFFER_ALIGNMENT - 1) / FRAME_BUFFER_ALIGNMENT * FRAME_BUFFER_ALIGNMENT;
+  }
+  if (!allocate)
+  {
+    size_ = 0;
+  }
+  else
+  {
+    void* data = nullptr;
+    if (posix_memalign(&data, FRAME_BUFFER_ALIGNMENT, size_ > 0 ? size_ : FRAME_BUFFER_ALIGNMENT) != 0)
+    {
+      throw std::bad_alloc();
+    }
+    data_ = static_cast<uint8_t*>(data);
+  }
+  for (int plane = 0; plane < plane_count; plane += 1)
+  {
+    bindPlane(frame_plane(plane), nullptr);
+  }
+}
+
+FrameBuffer::~FrameBuffer()
+{
+  free(data_);
+}
+
+size_t FrameBuffer::getElementSize(frame_plane plane)
+{
+  switch (plane)
+  {
+    case plane_depth:
+    case plane_depth2:
+      return sizeof(float);
+    case plane_intensity:
+    case plane_intensity2:
+      return sizeof(uint16_t);
+    default:
+      return sizeof(uint8_t);
+  }
+}
+
+void FrameBuffer::clearRow(size_t row)
+{
+  for (int plane = 0; plane < plane_count; plane += 1)
+  {
+    if (plane == plane_depth || plane == plane_depth2)
+    {
+      // Missing depth is NaN so projected points are NaN as well
+      float* depth = getRow<float>(frame_plane(plane), row);
+      for (size_t col = 0; col < columns_; col += 1)
+      {
+        depth[col] = NAN;
+      }
+    }
+    else
+    {
+      memset(getRow<uint8_t>(frame_plane(plane), row), 0, getStep(frame_plane(plane)));
+    }
+  }
+}
+
+}  // namespace hfl
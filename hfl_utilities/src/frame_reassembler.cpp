@@ -0,0 +1,188 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// @file frame_reassembler.cpp
+///
+/// @brief This file implements the frame row reassembly class.
+///
+#include <frame_reassembler.h>
+
+#include <vector>
+
+namespace hfl
+{
+FrameReassembler::FrameReassembler(uint16_t rows, size_t slots, double timeout)
+  : rows_(rows)
+  , full_mask_((rows >= 32) ? 0xffffffff : ((1u << rows) - 1))
+  , timeout_(timeout)
+  , slots_((slots < 1) ? 1 : slots)
+  , has_retired_(false)
+  , newest_retired_(0)
+  , completed_count_(0)
+  , late_count_(0)
+  , evicted_count_(0)
+  , duplicate_count_(0)
+{
+}
+
+RowInsertion FrameReassembler::insert(uint32_t frame_number, uint16_t row, double stamp)
+{
+  RowInsertion result;
+  if (row >= rows_ || row >= 32)
+  {
+    result.status = row_invalid;
+    return result;
+  }
+
+  // Look for the frame among the in-flight ones
+  size_t slot = slots_.size();
+  for (size_t i = 0; i < slots_.size(); i += 1)
+  {
+    if (slots_[i].active && slots_[i].frame_number == frame_number)
+    {
+      slot = i;
+      break;
+    }
+  }
+
+  if (slot == slots_.size())
+  {
+    // Frame not in flight, check whether it was already retired
+    if (has_retired_)
+    {
+      int32_t lag = static_cast<int32_t>(frame_number - newest_retired_);
+      if (lag <= 0 && lag > -REASSEMBLY_MAX_LAG)
+      {
+        late_count_ += 1;
+        result.status = row_late;
+        return result;
+      }
+      if (lag <= 0)
+      {
+        // Far behind, the sensor restarted its frame counter
+        has_retired_ = false;
+      }
+    }
+
+    // Take a free slot, or push out the oldest in-flight frame
+    size_t oldest = 0;
+    for (size_t i = 0; i < slots_.size(); i += 1)
+    {
+      if (!slots_[i].active)
+      {
+        slot = i;
+        break;
+      }
+      if (static_cast<int32_t>(slots_[i].frame_number - slots_[oldest].frame_number) < 0)
+      {
+        oldest = i;
+      }
+    }
+    if (slot == slots_.size())
+    {
+      // Never push out a newer frame for an older one
+      if (static_cast<int32_t>(frame_number - slots_[oldest].frame_number) < 0)
+      {
+        late_count_ += 1;
+        result.status = row_late;
+        return result;
+      }
+      slot = oldest;
+      result.evicted = true;
+      result.evicted_frame = getSlot(slot);
+      evicted_count_ += 1;
+      retire(slot);
+    }
+
+    slots_[slot].active = true;
+    slots_[slot].frame_number = frame_number;
+    slots_[slot].row_mask = 0;
+    slots_[slot].start_time = stamp;
+    result.started = true;
+  }
+
+  result.slot = slot;
+  uint32_t bit = 1u << row;
+  if (slots_[slot].row_mask & bit)
+  {
+    duplicate_count_ += 1;
+    result.status = row_duplicate;
+    return result;
+  }
+
+  slots_[slot].row_mask |= bit;
+  result.status = row_accepted;
+  if (slots_[slot].row_mask == full_mask_)
+  {
+    result.complete = true;
+    completed_count_ += 1;
+    retire(slot);
+  }
+  return result;
+}
+
+bool FrameReassembler::expire(double now, FrameSlotInfo& frame)
+{
+  for (size_t i = 0; i < slots_.size(); i += 1)
+  {
+    if (slots_[i].active && (now - slots_[i].start_time) > timeout_)
+    {
+      frame = getSlot(i);
+      evicted_count_ += 1;
+      retire(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+FrameSlotInfo FrameReassembler::getSlot(size_t slot) const
+{
+  FrameSlotInfo info;
+  info.slot = slot;
+  info.frame_number = slots_[slot].frame_number;
+  info.row_mask = slots_[slot].row_mask;
+  info.start_time = slots_[slot].start_time;
+  return info;
+}
+
+void FrameReassembler::retire(size_t slot)
+{
+  slots_[slot].active = false;
+  if (!has_retired_ ||
+      static_cast<int32_t>(slots_[slot].frame_number - newest_retired_) > 0)
+  {
+    newest_retired_ = slots_[slot].frame_number;
+    has_retired_ = true;
+  }
+}
+
+}  // namespace hfl
@@ -59,4 +59,27 @@ std::shared_ptr<Frame> HflInterface::frame()
   return frame_;
 }
 
+bool HflInterface::processPacket(packet_channel channel, PacketView data)
+{
+  switch (channel)
+  {
+    case channel_frame:
+      return processFrameData(data);
+    case channel_object:
+      return processObjectData(data);
+    case channel_tele:
+      return processTelemetryData(data);
+    case channel_slice:
+      return processSliceData(data);
+    default:
+      // PDM data is not processed yet
+      return false;
+  }
+}
+
+void HflInterface::setProfiler(std::shared_ptr<StageProfiler> profiler)
+{
+  profiler_ = profiler;
+}
+
 }  // namespace hfl
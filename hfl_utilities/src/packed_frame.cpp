@@ -0,0 +1,107 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// @file packed_frame.cpp
+///
+/// @brief This file implements the layout of the packed frame buffer.
+///
+#include <packed_frame.h>
+
+#include <cmath>
+#include <cstring>
+
+namespace hfl
+{
+PackedFrameLayout::PackedFrameLayout(uint16_t rows, uint16_t columns)
+  : rows_(rows), columns_(columns), size_(0)
+{
+  // Planes back to back, wider elements first so every plane stays aligned
+  for (int plane = 0; plane < packed_plane_count; plane += 1)
+  {
+    offsets_[plane] = size_;
+    size_ += size_t(rows_) * getStep(packed_plane(plane));
+  }
+}
+
+size_t PackedFrameLayout::getElementSize(packed_plane plane)
+{
+  switch (plane)
+  {
+    case packed_range:
+    case packed_range2:
+      return sizeof(float);
+    case packed_intensity:
+    case packed_intensity2:
+      return sizeof(uint16_t);
+    default:
+      return sizeof(uint8_t);
+  }
+}
+
+DecodedRow PackedFrameLayout::getRangeRow(uint8_t* data, size_t row) const
+{
+  DecodedRow planes;
+  planes.range_1 = getRow<float>(data, packed_range, row);
+  planes.range_2 = getRow<float>(data, packed_range2, row);
+  planes.intensity_1 = getRow<uint16_t>(data, packed_intensity, row);
+  planes.intensity_2 = getRow<uint16_t>(data, packed_intensity2, row);
+  return planes;
+}
+
+void PackedFrameLayout::copyRanges(uint8_t* data, size_t row, const DecodedRow& ranges) const
+{
+  DecodedRow planes = getRangeRow(data, row);
+  memcpy(planes.range_1, ranges.range_1, getStep(packed_range));
+  memcpy(planes.range_2, ranges.range_2, getStep(packed_range2));
+  memcpy(planes.intensity_1, ranges.intensity_1, getStep(packed_intensity));
+  memcpy(planes.intensity_2, ranges.intensity_2, getStep(packed_intensity2));
+}
+
+void PackedFrameLayout::copyFlags(uint8_t* data, size_t row, const uint8_t* flags) const
+{
+  memcpy(getRow<uint8_t>(data, packed_flags, row), flags, getStep(packed_flags));
+}
+
+void PackedFrameLayout::clearRow(uint8_t* data, size_t row) const
+{
+  // Missing ranges are NaN like the depth images
+  DecodedRow planes = getRangeRow(data, row);
+  for (size_t col = 0; col < columns_; col += 1)
+  {
+    planes.range_1[col] = NAN;
+    planes.range_2[col] = NAN;
+  }
+  memset(planes.intensity_1, 0, getStep(packed_intensity));
+  memset(planes.intensity_2, 0, getStep(packed_intensity2));
+  memset(getRow<uint8_t>(data, packed_flags, row), 0, getStep(packed_flags));
+}
+
+}  // namespace hfl
@@ -0,0 +1,189 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// @file packet_encoder.cpp
+///
+/// @brief This file implements the HFL110DCU packet encoder used to emulate sensors.
+///
+#include <packet_encoder.h>
+#include <packet_layout.h>
+
+#include <cmath>
+#include <cstring>
+#include <string>
+
+namespace hfl
+{
+namespace
+{
+typedef FrameLayoutV1 Frame;
+typedef ObjectLayoutV1 Object;
+typedef ObjectRecordLayoutV1 Record;
+typedef TelemetryLayoutV1 Telemetry;
+
+static_assert(Frame::Packet::size == FRAME_PACKET_SIZE, "frame packet size");
+static_assert(Frame::Pixels::offset == FRAME_DATA_OFFSET, "frame data offset");
+static_assert(Object::Records::offset == OBJECT_DATA_OFFSET, "object data offset");
+static_assert(Record::Record::size == OBJECT_RECORD_SIZE, "object record size");
+static_assert(Telemetry::Packet::size == TELEMETRY_PACKET_SIZE, "telemetry packet size");
+}  // namespace
+
+PacketEncoder::PacketEncoder(const SensorCalibration& calibration) : calibration_(calibration)
+{
+}
+
+void PacketEncoder::encodeFrameRow(PacketBuffer& buffer, uint32_t frame_number, uint32_t packet_row,
+                                   uint64_t sensor_time, const FrameRowData& row) const
+{
+  uint8_t* packet = buffer.data;
+  memset(packet, 0, FRAME_PACKET_SIZE);
+
+  // Header: versions, timestamp, frame number and row
+  Frame::UdpVersion::store(packet, 1);
+  Frame::PcaVersion::store(packet, 1);
+  Frame::RowNumber::store(packet, packet_row);
+  setFrameHeader(buffer, frame_number, sensor_time);
+
+  // Intrinsics
+  const SensorCalibration& c = calibration_;
+  Frame::Fx::store(packet, c.fx);
+  Frame::Fy::store(packet, c.fy);
+  Frame::Ux::store(packet, c.ux);
+  Frame::Uy::store(packet, c.uy);
+  Frame::R1::store(packet, c.r1);
+  Frame::R2::store(packet, c.r2);
+  Frame::T1::store(packet, c.t1);
+  Frame::T2::store(packet, c.t2);
+  Frame::R4::store(packet, c.r4);
+
+  // Extrinsics
+  Frame::IntrinsicYaw::store(packet, c.intrinsic_yaw);
+  Frame::IntrinsicPitch::store(packet, c.intrinsic_pitch);
+  Frame::ExtrinsicYaw::store(packet, c.extrinsic_yaw);
+  Frame::ExtrinsicPitch::store(packet, c.extrinsic_pitch);
+  Frame::ExtrinsicRoll::store(packet, c.extrinsic_roll);
+  Frame::ExtrinsicZ::store(packet, c.extrinsic_z);
+  Frame::ExtrinsicY::store(packet, c.extrinsic_y);
+  Frame::ExtrinsicX::store(packet, c.extrinsic_x);
+
+  // Pixel data: ranges, intensities, then classification flags
+  for (size_t col = 0; col < ENCODER_COLUMNS; col += 1)
+  {
+    Frame::Ranges::store(packet, col * 2, row.range[col][0]);
+    Frame::Ranges::store(packet, col * 2 + 1, row.range[col][1]);
+    Frame::Intensities::store(packet, col * 2, row.intensity[col][0]);
+    Frame::Intensities::store(packet, col * 2 + 1, row.intensity[col][1]);
+    Frame::Flags::store(packet, col, row.flags[col]);
+  }
+  buffer.size = FRAME_PACKET_SIZE;
+}
+
+void PacketEncoder::setFrameHeader(PacketBuffer& buffer, uint32_t frame_number, uint64_t sensor_time)
+{
+  Frame::Timestamp::store(buffer.data, sensor_time);
+  Frame::FrameNumber::store(buffer.data, frame_number);
+}
+
+void PacketEncoder::encodeObjects(PacketBuffer& buffer, const EncodedObject* objects, size_t count,
+                                  bool last) const
+{
+  uint8_t* packet = buffer.data;
+  if (count > OBJECTS_FIRST_PACKET)
+  {
+    count = OBJECTS_FIRST_PACKET;
+  }
+  memset(packet, 0, OBJECT_DATA_OFFSET + OBJECTS_FIRST_PACKET * OBJECT_RECORD_SIZE);
+
+  // Bit 0 marks the second packet of a frame
+  Object::PacketIndex::store(packet, last ? 1 : 0);
+
+  for (size_t i = 0; i < count; i += 1)
+  {
+    const EncodedObject& object = objects[i];
+
+    // Box corners from center, size and heading
+    uint8_t* record = packet + OBJECT_DATA_OFFSET + i * OBJECT_RECORD_SIZE;
+    float c = std::cos(object.yaw);
+    float s = std::sin(object.yaw);
+    float half_length = object.length / 2;
+    float half_width = object.width / 2;
+    Record::Geometry::store(record, 0, object.x - c * half_length + s * half_width);
+    Record::Geometry::store(record, 1, object.y - s * half_length - c * half_width);
+    Record::Geometry::store(record, 2, object.x - c * half_length - s * half_width);
+    Record::Geometry::store(record, 3, object.y - s * half_length + c * half_width);
+    Record::Geometry::store(record, 4, object.x + c * half_length - s * half_width);
+    Record::Geometry::store(record, 5, object.y + s * half_length + c * half_width);
+    Record::Geometry::store(record, 6, object.height);
+    Record::Geometry::store(record, 8, object.x);
+    Record::Geometry::store(record, 9, object.y);
+    Record::Geometry::store(record, 10, object.yaw);
+    Record::Kinematics::store(record, 0, object.vx);
+    Record::Kinematics::store(record, 1, object.vy);
+    Record::Classification::store(record, object.classification);
+    Record::Confidence::store(record, object.confidence);
+  }
+  buffer.size = OBJECT_DATA_OFFSET + count * OBJECT_RECORD_SIZE;
+}
+
+void PacketEncoder::encodeTelemetry(PacketBuffer& buffer, uint32_t frame_counter,
+                                    float sensor_temperature, const std::string& serial_number) const
+{
+  uint8_t* packet = buffer.data;
+  memset(packet, 0, TELEMETRY_PACKET_SIZE);
+  Telemetry::HardwareRevision::store(packet, 1);
+  Telemetry::SensorTemperature::store(packet, sensor_temperature);
+  // Heater temperature is sent negated
+  Telemetry::HeaterTemperature::store(packet, -sensor_temperature);
+  Telemetry::FrameCounter::store(packet, frame_counter);
+  Telemetry::UbattSwitched::store(packet, 12.0f);
+  Telemetry::Ubatt::store(packet, 12.0f);
+  Telemetry::AcquisitionPeriod::store(packet, 0.04f);
+
+  // Serial number is sent in reverse character order
+  for (size_t i = 0; i < serial_number.size() && i < Telemetry::SerialNumber::count; i += 1)
+  {
+    Telemetry::SerialNumber::store(packet, Telemetry::SerialNumber::count - 1 - i, serial_number[i]);
+  }
+  buffer.size = TELEMETRY_PACKET_SIZE;
+}
+
+void PacketEncoder::encodeSlice(PacketBuffer& buffer, uint32_t frame_number, uint64_t sensor_time) const
+{
+  uint8_t* packet = buffer.data;
+  memset(packet, 0, SLICE_PACKET_SIZE);
+  // Slices share the frame header
+  Frame::UdpVersion::store(packet, 1);
+  Frame::PcaVersion::store(packet, 1);
+  Frame::Timestamp::store(packet, sensor_time);
+  Frame::FrameNumber::store(packet, frame_number);
+  buffer.size = SLICE_PACKET_SIZE;
+}
+
+}  // namespace hfl
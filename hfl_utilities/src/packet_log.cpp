@@ -0,0 +1,135 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// @file packet_log.cpp
+///
+/// @brief This file implements the packet log file reader and writer.
+///
+#include <packet_log.h>
+#include <hfl_interface.h>
+
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace hfl
+{
+bool PacketLogWriter::open(const std::string& path)
+{
+  file_.open(path, std::ios::binary | std::ios::trunc);
+  if (!file_)
+  {
+    std::cout << "[ERROR] packet log " << path << " not created" << std::endl;
+    return false;
+  }
+  file_.write(PACKET_LOG_MAGIC, sizeof(PACKET_LOG_MAGIC));
+  return bool(file_);
+}
+
+bool PacketLogWriter::write(packet_channel channel, PacketView packet)
+{
+  PacketRecordHeader header;
+  header.receive_time = packet.getReceiveTime();
+  header.size = static_cast<uint32_t>(packet.size());
+  header.channel = static_cast<uint16_t>(channel);
+  header.reserved = 0;
+  file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file_.write(reinterpret_cast<const char*>(packet.data()), packet.size());
+  return bool(file_);
+}
+
+void PacketLogWriter::close()
+{
+  if (file_.is_open())
+  {
+    file_.close();
+  }
+}
+
+bool PacketLogReader::open(const std::string& path)
+{
+  file_.open(path, std::ios::binary);
+  if (!file_)
+  {
+    std::cout << "[ERROR] packet log " << path << " not found" << std::endl;
+    return false;
+  }
+  char magic[sizeof(PACKET_LOG_MAGIC)];
+  if (!file_.read(magic, sizeof(magic)) || memcmp(magic, PACKET_LOG_MAGIC, sizeof(magic)) != 0)
+  {
+    std::cout << "[ERROR] " << path << " is not a packet log" << std::endl;
+    file_.close();
+    return false;
+  }
+  return true;
+}
+
+bool PacketLogReader::read(PacketBuffer& buffer, packet_channel& channel)
+{
+  PacketRecordHeader header;
+  if (!file_.read(reinterpret_cast<char*>(&header), sizeof(header)))
+  {
+    return false;
+  }
+  if (header.size > PACKET_BUFFER_SIZE || header.channel >= channel_count)
+  {
+    std::cout << "[ERROR] corrupt packet record of " << header.size << " bytes" << std::endl;
+    return false;
+  }
+  if (!file_.read(reinterpret_cast<char*>(buffer.data), header.size))
+  {
+    return false;
+  }
+  buffer.size = header.size;
+  buffer.receive_time = header.receive_time;
+  channel = static_cast<packet_channel>(header.channel);
+  return true;
+}
+
+size_t PacketLogReader::feed(HflInterface& camera)
+{
+  PacketBuffer buffer;
+  packet_channel channel;
+  size_t count = 0;
+  while (read(buffer, channel))
+  {
+    camera.processPacket(channel, buffer.view());
+    count += 1;
+  }
+  return count;
+}
+
+void PacketLogReader::rewind()
+{
+  file_.clear();
+  file_.seekg(sizeof(PACKET_LOG_MAGIC));
+}
+
+}  // namespace hfl
@@ -0,0 +1,223 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// @file packet_recorder.cpp
+///
+/// @brief This file implements the raw packet recorder class.
+///
+#include <packet_recorder.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <string>
+
+namespace hfl
+{
+PacketRecorder::PacketRecorder(size_t block_size, size_t blocks)
+  : block_size_(block_size)
+  , current_(0)
+  , file_fd_(-1)
+  , running_(false)
+  , recorded_count_(0)
+  , dropped_count_(0)
+  , written_bytes_(0)
+{
+  if (blocks < 2)
+  {
+    blocks = 2;
+  }
+  for (size_t i = 0; i < blocks; i += 1)
+  {
+    void* data = nullptr;
+    if (posix_memalign(&data, RECORDER_ALIGNMENT, block_size_) != 0)
+    {
+      break;
+    }
+    blocks_.push_back(Block{ static_cast<uint8_t*>(data), 0 });
+  }
+  for (size_t i = 1; i < blocks_.size(); i += 1)
+  {
+    free_.push_back(i);
+  }
+}
+
+PacketRecorder::~PacketRecorder()
+{
+  close();
+  for (Block& block : blocks_)
+  {
+    free(block.data);
+  }
+}
+
+bool PacketRecorder::open(const std::string& path)
+{
+  if (running_ || blocks_.size() < 2)
+  {
+    return false;
+  }
+  file_fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (file_fd_ < 0)
+  {
+    std::cout << "[ERROR] packet log " << path << " not created: " << strerror(errno) << std::endl;
+    return false;
+  }
+
+  // The magic starts the first block
+  memcpy(blocks_[current_].data, PACKET_LOG_MAGIC, sizeof(PACKET_LOG_MAGIC));
+  blocks_[current_].used = sizeof(PACKET_LOG_MAGIC);
+
+  running_ = true;
+  writer_thread_ = std::thread(&PacketRecorder::writeLoop, this);
+  return true;
+}
+
+void PacketRecorder::close()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+  }
+  ready_.notify_one();
+  if (writer_thread_.joinable())
+  {
+    writer_thread_.join();
+  }
+  if (file_fd_ >= 0)
+  {
+    ::close(file_fd_);
+    file_fd_ = -1;
+  }
+}
+
+bool PacketRecorder::record(packet_channel channel, PacketView packet)
+{
+  PacketRecordHeader header;
+  header.receive_time = packet.getReceiveTime();
+  if (header.receive_time == 0)
+  {
+    timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    header.receive_time = uint64_t(now.tv_sec) * 1000000000ULL + uint64_t(now.tv_nsec);
+  }
+  header.size = static_cast<uint32_t>(packet.size());
+  header.channel = static_cast<uint16_t>(channel);
+  header.reserved = 0;
+  size_t needed = sizeof(header) + packet.size();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!running_ || needed > block_size_)
+  {
+    return false;
+  }
+  if (blocks_[current_].used + needed > block_size_)
+  {
+    // Block full, hand it to the writer
+    if (free_.empty())
+    {
+      dropped_count_ += 1;
+      return false;
+    }
+    full_.push_back(current_);
+    current_ = free_.back();
+    free_.pop_back();
+    blocks_[current_].used = 0;
+    ready_.notify_one();
+  }
+
+  Block& block = blocks_[current_];
+  memcpy(block.data + block.used, &header, sizeof(header));
+  memcpy(block.data + block.used + sizeof(header), packet.data(), packet.size());
+  block.used += needed;
+  recorded_count_ += 1;
+  return true;
+}
+
+void PacketRecorder::writeLoop()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true)
+  {
+    bool woken = ready_.wait_for(lock, std::chrono::milliseconds(RECORDER_FLUSH_INTERVAL),
+                                 [this] { return !full_.empty() || !running_; });
+
+    // Nothing filled up for a while or stopping, write the partial block too
+    if ((!woken || !running_) && full_.empty() && blocks_[current_].used > 0 && !free_.empty())
+    {
+      full_.push_back(current_);
+      current_ = free_.back();
+      free_.pop_back();
+      blocks_[current_].used = 0;
+    }
+
+    while (!full_.empty())
+    {
+      size_t index = full_.front();
+      full_.pop_front();
+      Block block = blocks_[index];
+      lock.unlock();
+
+      // Write outside the lock, producers keep filling the current block
+      size_t written = 0;
+      while (written < block.used)
+      {
+        ssize_t result = write(file_fd_, block.data + written, block.used - written);
+        if (result < 0)
+        {
+          if (errno == EINTR)
+          {
+            continue;
+          }
+          std::cout << "[ERROR] packet log write failed: " << strerror(errno) << std::endl;
+          break;
+        }
+        written += result;
+      }
+      written_bytes_ += written;
+
+      lock.lock();
+      free_.push_back(index);
+    }
+
+    if (!running_ && blocks_[current_].used == 0)
+    {
+      break;
+    }
+  }
+}
+
+}  // namespace hfl
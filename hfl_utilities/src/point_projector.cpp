@@ -0,0 +1,84 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// @file point_projector.cpp
+///
+/// @brief This file implements the frame row point projector.
+///
+#include <point_projector.h>
+
+#include <cmath>
+#include <cstring>
+
+namespace hfl
+{
+namespace
+{
+/// Writes one point
+inline void writePoint(uint8_t* point, const float* ray, float range, uint16_t intensity, uint8_t number,
+                       uint8_t crosstalk, uint8_t saturated, uint8_t superimposed)
+{
+  float xyzi[4] = { ray[0] * range, ray[1] * range, ray[2] * range, float(intensity) };
+  memcpy(point + POINT_X_OFFSET, xyzi, sizeof(xyzi));
+  point[POINT_RETURN_OFFSET] = number;
+  point[POINT_CROSSTALK_OFFSET] = crosstalk;
+  point[POINT_SATURATED_OFFSET] = saturated;
+  point[POINT_SUPERIMPOSED_OFFSET] = superimposed;
+}
+}  // namespace
+
+PointProjector::PointProjector(size_t rows, size_t columns)
+  : rows_(rows), columns_(columns), rays_(rows * columns * 3, NAN)
+{
+}
+
+void PointProjector::setRay(size_t row, size_t col, float x, float y, float z)
+{
+  float* ray = &rays_[(row * columns_ + col) * 3];
+  ray[0] = x;
+  ray[1] = y;
+  ray[2] = z;
+}
+
+void PointProjector::projectRow(size_t row, const DecodedRow& ranges, const DecodedFlags& flags,
+                                uint8_t* points) const
+{
+  const float* ray = &rays_[row * columns_ * 3];
+  for (size_t col = 0; col < columns_; col += 1, ray += 3, points += 2 * POINT_STEP)
+  {
+    writePoint(points, ray, ranges.range_1[col], ranges.intensity_1[col], 1, flags.crosstalk[col],
+               flags.saturated[col], flags.superimposed[col]);
+    writePoint(points + POINT_STEP, ray, ranges.range_2[col], ranges.intensity_2[col], 2, flags.crosstalk_2[col],
+               flags.saturated_2[col], flags.superimposed_2[col]);
+  }
+}
+
+}  // namespace hfl
@@ -0,0 +1,112 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// @file range_table.cpp
+///
+/// @brief This file implements the double buffered range conversion table.
+///
+#include <range_table.h>
+
+#include <cmath>
+#include <thread>
+
+namespace hfl
+{
+RangeTable::RangeTable(float offset) : current_(0)
+{
+  for (Buffer& buffer : buffers_)
+  {
+    buffer.range.resize(RANGE_TABLE_SIZE);
+    buffer.conversion.table = buffer.range.data();
+    buffer.readers = 0;
+  }
+  fill(buffers_[0], offset);
+  fill(buffers_[1], offset);
+}
+
+void RangeTable::setOffset(float offset)
+{
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  size_t next = 1 - current_.load();
+
+  // A reader may still decode with the table published before the last
+  // swap, wait for it, rows take microseconds
+  while (buffers_[next].readers.load() != 0)
+  {
+    std::this_thread::yield();
+  }
+  fill(buffers_[next], offset);
+  current_.store(next);
+}
+
+float RangeTable::getOffset() const
+{
+  Reader reader(*this);
+  return reader.get().offset;
+}
+
+float RangeTable::convert(float offset, uint16_t word)
+{
+  // Same single precision steps as the vector decode kernels
+  float range = (offset + float(word)) * ROW_RANGE_SCALE;
+  return range > ROW_RANGE_CUTOFF ? NAN : range;
+}
+
+void RangeTable::fill(Buffer& buffer, float offset)
+{
+  for (size_t word = 0; word < RANGE_TABLE_SIZE; word += 1)
+  {
+    buffer.range[word] = convert(offset, uint16_t(word));
+  }
+  buffer.conversion.offset = offset;
+}
+
+RangeTable::Reader::Reader(const RangeTable& table) : table_(table), index_(0)
+{
+  // Register on the published table, retry if it was swapped meanwhile
+  while (true)
+  {
+    index_ = table_.current_.load();
+    table_.buffers_[index_].readers.fetch_add(1);
+    if (table_.current_.load() == index_)
+    {
+      break;
+    }
+    table_.buffers_[index_].readers.fetch_sub(1);
+  }
+}
+
+RangeTable::Reader::~Reader()
+{
+  table_.buffers_[index_].readers.fetch_sub(1);
+}
+
+}  // namespace hfl
@@ -0,0 +1,352 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// @file row_decoder.cpp
+///
+/// @brief This file implements the vectorized HFL110DCU frame row decoder.
+///
+#include <row_decoder.h>
+
+#include <cmath>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HFL_ROW_DECODER_X86
+#include <immintrin.h>
+#endif
+
+namespace hfl
+{
+namespace
+{
+void decodeScalar(const uint8_t* data, const RangeConversion& range_conversion, const DecodedRow& row)
+{
+  const float* table = range_conversion.table;
+  const uint8_t* range = data + ROW_RANGE_OFFSET;
+  const uint8_t* intensity = data + ROW_INTENSITY_OFFSET;
+  for (size_t col = 0; col < ROW_COLUMNS; col += 1)
+  {
+    // Big endian words, first and second return interleaved per column
+    const uint8_t* r = range + col * 4;
+    const uint8_t* i = intensity + col * 4;
+    row.range_1[col] = table[(r[0] << 8) | r[1]];
+    row.range_2[col] = table[(r[2] << 8) | r[3]];
+    row.intensity_1[col] = uint16_t((i[0] << 8) | i[1]);
+    row.intensity_2[col] = uint16_t((i[2] << 8) | i[3]);
+  }
+}
+
+void unpackFlagsScalar(const uint8_t* flags, const DecodedFlags& planes)
+{
+  for (size_t col = 0; col < ROW_COLUMNS; col += 1)
+  {
+    planes.crosstalk[col] = (flags[col] & FLAG_CROSSTALK) ? 255 : 0;
+    planes.saturated[col] = (flags[col] & FLAG_SATURATED) ? 255 : 0;
+    planes.superimposed[col] = (flags[col] & FLAG_SUPERIMPOSED) ? 255 : 0;
+    planes.crosstalk_2[col] = (flags[col] & FLAG_CROSSTALK_2) ? 255 : 0;
+    planes.saturated_2[col] = (flags[col] & FLAG_SATURATED_2) ? 255 : 0;
+    planes.superimposed_2[col] = (flags[col] & FLAG_SUPERIMPOSED_2) ? 255 : 0;
+  }
+}
+
+void packFlagsScalar(const uint8_t* flags, uint8_t* bits)
+{
+  std::memset(bits, 0, 8 * ROW_FLAG_PLANE_SIZE);
+  for (size_t col = 0; col < ROW_COLUMNS; col += 1)
+  {
+    for (size_t bit = 0; bit < 8; bit += 1)
+    {
+      bits[bit * ROW_FLAG_PLANE_SIZE + col / 8] |= ((flags[col] >> bit) & 1) << (col % 8);
+    }
+  }
+}
+
+#ifdef HFL_ROW_DECODER_X86
+// Byte-swaps 4 columns of interleaved words, first return to the low, second to the high half
+#define HFL_SWAP_DEINTERLEAVE 1, 0, 5, 4, 9, 8, 13, 12, 3, 2, 7, 6, 11, 10, 15, 14
+
+__attribute__((target("sse4.1"))) inline void storeRangeSse(float* out, __m128i words,
+                                                             __m128 offset, __m128 scale,
+                                                             __m128 cutoff, __m128 no_return)
+{
+  __m128 range = _mm_cvtepi32_ps(_mm_cvtepu16_epi32(words));
+  range = _mm_mul_ps(_mm_add_ps(range, offset), scale);
+  range = _mm_blendv_ps(range, no_return, _mm_cmpgt_ps(range, cutoff));
+  _mm_storeu_ps(out, range);
+}
+
+__attribute__((target("sse4.1"))) void decodeSse41(const uint8_t* data, const RangeConversion& range_conversion,
+                                                  const DecodedRow& row)
+{
+  const __m128i swap = _mm_setr_epi8(HFL_SWAP_DEINTERLEAVE);
+  const __m128 offsets = _mm_set1_ps(range_conversion.offset);
+  const __m128 scale = _mm_set1_ps(ROW_RANGE_SCALE);
+  const __m128 cutoff = _mm_set1_ps(ROW_RANGE_CUTOFF);
+  const __m128 no_return = _mm_set1_ps(NAN);
+  const uint8_t* range = data + ROW_RANGE_OFFSET;
+  const uint8_t* intensity = data + ROW_INTENSITY_OFFSET;
+
+  // 8 columns, 32 bytes of ranges and 32 bytes of intensities per iteration
+  for (size_t col = 0; col < ROW_COLUMNS; col += 8)
+  {
+    __m128i r_lo = _mm_shuffle_epi8(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(range + col * 4)), swap);
+    __m128i r_hi = _mm_shuffle_epi8(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(range + col * 4 + 16)), swap);
+    storeRangeSse(row.range_1 + col, r_lo, offsets, scale, cutoff, no_return);
+    storeRangeSse(row.range_1 + col + 4, r_hi, offsets, scale, cutoff, no_return);
+    storeRangeSse(row.range_2 + col, _mm_srli_si128(r_lo, 8), offsets, scale, cutoff,
+                  no_return);
+    storeRangeSse(row.range_2 + col + 4, _mm_srli_si128(r_hi, 8), offsets, scale, cutoff,
+                  no_return);
+
+    __m128i i_lo = _mm_shuffle_epi8(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(intensity + col * 4)), swap);
+    __m128i i_hi = _mm_shuffle_epi8(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(intensity + col * 4 + 16)), swap);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(row.intensity_1 + col),
+                     _mm_unpacklo_epi64(i_lo, i_hi));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(row.intensity_2 + col),
+                     _mm_unpackhi_epi64(i_lo, i_hi));
+  }
+}
+
+__attribute__((target("avx2"))) inline void storeRangeAvx(float* out, __m128i words,
+                                                          __m256 offset, __m256 scale,
+                                                          __m256 cutoff, __m256 no_return)
+{
+  __m256 range = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(words));
+  range = _mm256_mul_ps(_mm256_add_ps(range, offset), scale);
+  range = _mm256_blendv_ps(range, no_return, _mm256_cmp_ps(range, cutoff, _CMP_GT_OQ));
+  _mm256_storeu_ps(out, range);
+}
+
+__attribute__((target("avx2"))) inline __m256i loadSwappedAvx(const uint8_t* data, __m256i swap)
+{
+  // Each lane holds 4 columns, gather the first return into the low lane
+  __m256i words = _mm256_shuffle_epi8(
+    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data)), swap);
+  return _mm256_permute4x64_epi64(words, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+__attribute__((target("avx2"))) void decodeAvx2(const uint8_t* data, const RangeConversion& range_conversion,
+                                               const DecodedRow& row)
+{
+  const __m256i swap = _mm256_setr_epi8(HFL_SWAP_DEINTERLEAVE, HFL_SWAP_DEINTERLEAVE);
+  const __m256 offsets = _mm256_set1_ps(range_conversion.offset);
+  const __m256 scale = _mm256_set1_ps(ROW_RANGE_SCALE);
+  const __m256 cutoff = _mm256_set1_ps(ROW_RANGE_CUTOFF);
+  const __m256 no_return = _mm256_set1_ps(NAN);
+  const uint8_t* range = data + ROW_RANGE_OFFSET;
+  const uint8_t* intensity = data + ROW_INTENSITY_OFFSET;
+
+  // 16 columns, 64 bytes of ranges and 64 bytes of intensities per iteration
+  for (size_t col = 0; col < ROW_COLUMNS; col += 16)
+  {
+    __m256i r_lo = loadSwappedAvx(range + col * 4, swap);
+    __m256i r_hi = loadSwappedAvx(range + col * 4 + 32, swap);
+    storeRangeAvx(row.range_1 + col, _mm256_castsi256_si128(r_lo), offsets, scale, cutoff,
+                  no_return);
+    storeRangeAvx(row.range_1 + col + 8, _mm256_castsi256_si128(r_hi), offsets, scale, cutoff,
+                  no_return);
+    storeRangeAvx(row.range_2 + col, _mm256_extracti128_si256(r_lo, 1), offsets, scale, cutoff,
+                  no_return);
+    storeRangeAvx(row.range_2 + col + 8, _mm256_extracti128_si256(r_hi, 1), offsets, scale,
+                  cutoff, no_return);
+
+    __m256i i_lo = loadSwappedAvx(intensity + col * 4, swap);
+    __m256i i_hi = loadSwappedAvx(intensity + col * 4 + 32, swap);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(row.intensity_1 + col),
+                        _mm256_permute2x128_si256(i_lo, i_hi, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(row.intensity_2 + col),
+                        _mm256_permute2x128_si256(i_lo, i_hi, 0x31));
+  }
+}
+
+__attribute__((target("sse4.1"))) inline void storeFlagSse(uint8_t* out, __m128i flags,
+                                                            uint8_t flag)
+{
+  const __m128i mask = _mm_set1_epi8(char(flag));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+                   _mm_cmpeq_epi8(_mm_and_si128(flags, mask), mask));
+}
+
+__attribute__((target("sse4.1"))) void unpackFlagsSse41(const uint8_t* flags,
+                                                       const DecodedFlags& planes)
+{
+  // 16 columns per iteration
+  for (size_t col = 0; col < ROW_COLUMNS; col += 16)
+  {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(flags + col));
+    storeFlagSse(planes.crosstalk + col, bytes, FLAG_CROSSTALK);
+    storeFlagSse(planes.saturated + col, bytes, FLAG_SATURATED);
+    storeFlagSse(planes.superimposed + col, bytes, FLAG_SUPERIMPOSED);
+    storeFlagSse(planes.crosstalk_2 + col, bytes, FLAG_CROSSTALK_2);
+    storeFlagSse(planes.saturated_2 + col, bytes, FLAG_SATURATED_2);
+    storeFlagSse(planes.superimposed_2 + col, bytes, FLAG_SUPERIMPOSED_2);
+  }
+}
+
+__attribute__((target("sse4.1"))) void packFlagsSse41(const uint8_t* flags, uint8_t* bits)
+{
+  // 16 columns per iteration, shift each flag bit to the byte sign bit and gather it
+  for (size_t col = 0; col < ROW_COLUMNS; col += 16)
+  {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(flags + col));
+    for (int bit = 0; bit < 8; bit += 1)
+    {
+      uint16_t mask = uint16_t(_mm_movemask_epi8(_mm_sll_epi16(bytes, _mm_cvtsi32_si128(7 - bit))));
+      std::memcpy(bits + bit * ROW_FLAG_PLANE_SIZE + col / 8, &mask, sizeof(mask));
+    }
+  }
+}
+
+__attribute__((target("avx2"))) inline void storeFlagAvx(uint8_t* out, __m256i flags,
+                                                         uint8_t flag)
+{
+  const __m256i mask = _mm256_set1_epi8(char(flag));
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(out),
+                      _mm256_cmpeq_epi8(_mm256_and_si256(flags, mask), mask));
+}
+
+__attribute__((target("avx2"))) void unpackFlagsAvx2(const uint8_t* flags,
+                                                    const DecodedFlags& planes)
+{
+  // 32 columns per iteration
+  for (size_t col = 0; col < ROW_COLUMNS; col += 32)
+  {
+    __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(flags + col));
+    storeFlagAvx(planes.crosstalk + col, bytes, FLAG_CROSSTALK);
+    storeFlagAvx(planes.saturated + col, bytes, FLAG_SATURATED);
+    storeFlagAvx(planes.superimposed + col, bytes, FLAG_SUPERIMPOSED);
+    storeFlagAvx(planes.crosstalk_2 + col, bytes, FLAG_CROSSTALK_2);
+    storeFlagAvx(planes.saturated_2 + col, bytes, FLAG_SATURATED_2);
+    storeFlagAvx(planes.superimposed_2 + col, bytes, FLAG_SUPERIMPOSED_2);
+  }
+}
+
+__attribute__((target("avx2"))) void packFlagsAvx2(const uint8_t* flags, uint8_t* bits)
+{
+  // 32 columns per iteration
+  for (size_t col = 0; col < ROW_COLUMNS; col += 32)
+  {
+    __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(flags + col));
+    for (int bit = 0; bit < 8; bit += 1)
+    {
+      uint32_t mask = uint32_t(
+        _mm256_movemask_epi8(_mm256_sll_epi16(bytes, _mm_cvtsi32_si128(7 - bit))));
+      std::memcpy(bits + bit * ROW_FLAG_PLANE_SIZE + col / 8, &mask, sizeof(mask));
+    }
+  }
+}
+
+#undef HFL_SWAP_DEINTERLEAVE
+#endif  // HFL_ROW_DECODER_X86
+
+}  // namespace
+
+RowDecoder::RowDecoder()
+  : decode_(&decodeScalar)
+  , unpack_flags_(&unpackFlagsScalar)
+  , pack_flags_(&packFlagsScalar)
+  , isa_(isa_scalar)
+{
+  if (isSupported(isa_avx2))
+  {
+    *this = RowDecoder(isa_avx2);
+  }
+  else if (isSupported(isa_sse41))
+  {
+    *this = RowDecoder(isa_sse41);
+  }
+}
+
+RowDecoder::RowDecoder(row_decoder_isa isa)
+  : decode_(&decodeScalar)
+  , unpack_flags_(&unpackFlagsScalar)
+  , pack_flags_(&packFlagsScalar)
+  , isa_(isa_scalar)
+{
+  if (!isSupported(isa))
+  {
+    return;
+  }
+#ifdef HFL_ROW_DECODER_X86
+  if (isa == isa_avx2)
+  {
+    decode_ = &decodeAvx2;
+    unpack_flags_ = &unpackFlagsAvx2;
+    pack_flags_ = &packFlagsAvx2;
+    isa_ = isa_avx2;
+  }
+  else if (isa == isa_sse41)
+  {
+    decode_ = &decodeSse41;
+    unpack_flags_ = &unpackFlagsSse41;
+    pack_flags_ = &packFlagsSse41;
+    isa_ = isa_sse41;
+  }
+#endif
+}
+
+bool RowDecoder::isSupported(row_decoder_isa isa)
+{
+  switch (isa)
+  {
+    case isa_scalar:
+      return true;
+#ifdef HFL_ROW_DECODER_X86
+    case isa_sse41:
+      return __builtin_cpu_supports("sse4.1");
+    case isa_avx2:
+      return __builtin_cpu_supports("avx2");
+#endif
+    default:
+      return false;
+  }
+}
+
+const char* RowDecoder::getIsaName(row_decoder_isa isa)
+{
+  switch (isa)
+  {
+    case isa_scalar:
+      return "scalar";
+    case isa_sse41:
+      return "sse4.1";
+    case isa_avx2:
+      return "avx2";
+    default:
+      return "unknown";
+  }
+}
+
+}  // namespace hfl
@@ -0,0 +1,280 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// @file udp_receiver.cpp
+///
+/// @brief This file implements the native UDP receiver class.
+///
+#include <udp_receiver.h>
+
+#include <arpa/inet.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <string>
+
+namespace hfl
+{
+UdpReceiver::UdpReceiver(const std::string& source_address, uint16_t port,
+                         const Callback& callback, size_t queue_size)
+  : source_address_(inet_addr(source_address.c_str()))
+  , port_(port)
+  , callback_(callback)
+  , socket_fd_(-1)
+  , event_fd_(eventfd(0, EFD_NONBLOCK))
+  , queue_(queue_size)
+  , running_(false)
+  , received_count_(0)
+  , dropped_count_(0)
+{
+}
+
+UdpReceiver::~UdpReceiver()
+{
+  stop();
+  if (socket_fd_ >= 0)
+  {
+    close(socket_fd_);
+  }
+  if (event_fd_ >= 0)
+  {
+    close(event_fd_);
+  }
+}
+
+bool UdpReceiver::open(const std::string& local_address)
+{
+  socket_fd_ = socket(AF_INET, SOCK_DGRAM, 0);
+  if (socket_fd_ < 0)
+  {
+    std::cout << "[ERROR] socket for port " << port_ << " not created: " << strerror(errno) << std::endl;
+    return false;
+  }
+
+  // Ask the kernel to stamp every datagram on arrival
+  int enable = 1;
+  if (setsockopt(socket_fd_, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)) < 0)
+  {
+    std::cout << "[WARN] port " << port_ << " has no kernel timestamps, "
+              << "using read time instead: " << strerror(errno) << std::endl;
+  }
+
+  // Bind to the given local address, any address if it is not valid
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port_);
+  if (inet_pton(AF_INET, local_address.c_str(), &address.sin_addr) != 1)
+  {
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+  }
+
+  if (bind(socket_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0)
+  {
+    std::cout << "[ERROR] port " << port_ << " not bound: " << strerror(errno) << std::endl;
+    close(socket_fd_);
+    socket_fd_ = -1;
+    return false;
+  }
+  return true;
+}
+
+bool UdpReceiver::start()
+{
+  if (running_ || socket_fd_ < 0 || event_fd_ < 0)
+  {
+    return false;
+  }
+  running_ = true;
+  consumer_thread_ = std::thread(&UdpReceiver::consumeLoop, this);
+  receive_thread_ = std::thread(&UdpReceiver::receiveLoop, this);
+  return true;
+}
+
+void UdpReceiver::stop()
+{
+  running_ = false;
+  if (receive_thread_.joinable())
+  {
+    receive_thread_.join();
+  }
+  if (consumer_thread_.joinable())
+  {
+    consumer_thread_.join();
+  }
+}
+
+void UdpReceiver::receiveLoop()
+{
+  pollfd poll_fd = { socket_fd_, POLLIN, 0 };
+  while (running_)
+  {
+    // Wake up periodically to check the running flag
+    if (poll(&poll_fd, 1, UDP_POLL_TIMEOUT) > 0 && (poll_fd.revents & POLLIN))
+    {
+      receiveBatch();
+    }
+  }
+}
+
+void UdpReceiver::receiveBatch()
+{
+  mmsghdr messages[UDP_BATCH_SIZE];
+  iovec iovecs[UDP_BATCH_SIZE];
+  sockaddr_in addresses[UDP_BATCH_SIZE];
+  alignas(cmsghdr) uint8_t controls[UDP_BATCH_SIZE][UDP_CONTROL_SIZE];
+
+  int received = UDP_BATCH_SIZE;
+  // Keep reading while the kernel fills complete batches
+  while (received == static_cast<int>(UDP_BATCH_SIZE))
+  {
+    size_t batch = queue_.available(UDP_BATCH_SIZE);
+    if (batch == 0)
+    {
+      // Queue is full, drain one datagram so the socket does not stall
+      if (recv(socket_fd_, overflow_buffer_.data, PACKET_BUFFER_SIZE, MSG_DONTWAIT) >= 0)
+      {
+        queue_.overflow(1);
+        continue;
+      }
+      return;
+    }
+
+    memset(messages, 0, sizeof(messages));
+    for (size_t i = 0; i < batch; i += 1)
+    {
+      // Receive straight into the queue buffers
+      PacketBuffer& buffer = queue_.claim(i);
+      iovecs[i].iov_base = buffer.data;
+      iovecs[i].iov_len = PACKET_BUFFER_SIZE;
+      messages[i].msg_hdr.msg_iov = &iovecs[i];
+      messages[i].msg_hdr.msg_iovlen = 1;
+      messages[i].msg_hdr.msg_name = &addresses[i];
+      messages[i].msg_hdr.msg_namelen = sizeof(addresses[i]);
+      messages[i].msg_hdr.msg_control = controls[i];
+      messages[i].msg_hdr.msg_controllen = UDP_CONTROL_SIZE;
+    }
+
+    received = recvmmsg(socket_fd_, messages, batch, MSG_DONTWAIT, nullptr);
+    if (received <= 0)
+    {
+      return;
+    }
+
+    // Fallback stamp for datagrams without a kernel timestamp
+    timespec read_time;
+    clock_gettime(CLOCK_REALTIME, &read_time);
+
+    // Compact accepted datagrams to the front of the claimed buffers
+    size_t accepted = 0;
+    for (int i = 0; i < received; i += 1)
+    {
+      // Drop datagrams from other hosts and datagrams larger than the buffer
+      if (addresses[i].sin_addr.s_addr != source_address_ ||
+          (messages[i].msg_hdr.msg_flags & MSG_TRUNC))
+      {
+        dropped_count_ += 1;
+        continue;
+      }
+      PacketBuffer& buffer = queue_.claim(accepted);
+      if (accepted != static_cast<size_t>(i))
+      {
+        memcpy(buffer.data, queue_.claim(i).data, messages[i].msg_len);
+      }
+      buffer.size = messages[i].msg_len;
+      buffer.port = port_;
+      buffer.receive_time = receiveTime(messages[i].msg_hdr, read_time);
+      accepted += 1;
+    }
+
+    if (accepted > 0)
+    {
+      queue_.commit(accepted);
+      received_count_ += accepted;
+      // Wake up the consumer
+      uint64_t event = 1;
+      if (write(event_fd_, &event, sizeof(event)) < 0)
+      {
+        // Counter saturated, the consumer is awake anyway
+      }
+    }
+    if (batch < UDP_BATCH_SIZE && received == static_cast<int>(batch))
+    {
+      // Batch limited by queue space, keep draining
+      received = UDP_BATCH_SIZE;
+    }
+  }
+}
+
+uint64_t UdpReceiver::receiveTime(msghdr& message, const timespec& fallback)
+{
+  timespec stamp = fallback;
+  for (cmsghdr* control = CMSG_FIRSTHDR(&message); control != nullptr;
+       control = CMSG_NXTHDR(&message, control))
+  {
+    if (control->cmsg_level == SOL_SOCKET && control->cmsg_type == SCM_TIMESTAMPNS)
+    {
+      memcpy(&stamp, CMSG_DATA(control), sizeof(stamp));
+      break;
+    }
+  }
+  return uint64_t(stamp.tv_sec) * 1000000000ULL + uint64_t(stamp.tv_nsec);
+}
+
+void UdpReceiver::consumeLoop()
+{
+  pollfd poll_fd = { event_fd_, POLLIN, 0 };
+  while (running_)
+  {
+    const PacketBuffer* buffer;
+    while ((buffer = queue_.front()) != nullptr)
+    {
+      callback_(buffer->view());
+      queue_.pop();
+    }
+    // Sleep until the receive thread commits new datagrams
+    if (poll(&poll_fd, 1, UDP_POLL_TIMEOUT) > 0)
+    {
+      uint64_t events;
+      if (read(event_fd_, &events, sizeof(events)) < 0)
+      {
+        // Nothing to reset, another wake up already consumed the event
+      }
+    }
+  }
+}
+
+}  // namespace hfl
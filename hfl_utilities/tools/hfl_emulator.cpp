@@ -0,0 +1,364 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// @file hfl_emulator.cpp
+///
+/// @brief This file implements the HFL110DCU sensor emulator.
+///
+/// Sends frame, object, telemetry and slice datagrams of any number of
+/// synthetic sensors over loopback. Sensor i sends from source address
+/// + i to the destination ports + i * port stride, so every emulated
+/// sensor is a separate driver instance (camera_ip_address, *_data_port).
+///
+#include <packet_encoder.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+/// Frame rows per frame
+const uint32_t EMULATOR_ROWS{ 32 };
+
+/// Emulator settings
+struct EmulatorOptions
+{
+  int sensors{ 1 };
+  double rate{ 25.0 };
+  double duration{ 10.0 };
+  double loss{ 0.0 };
+  double reorder{ 0.0 };
+  std::string source{ "127.0.0.10" };
+  std::string destination{ "127.0.0.1" };
+  int frame_port{ 57410 };
+  int port_stride{ 10 };
+};
+
+/// Per sensor counters
+struct EmulatorStats
+{
+  std::atomic<uint64_t> frames{ 0 };
+  std::atomic<uint64_t> sent{ 0 };
+  std::atomic<uint64_t> lost{ 0 };
+  std::atomic<uint64_t> errors{ 0 };
+};
+
+std::atomic<bool> running(true);
+
+void stopEmulator(int)
+{
+  running = false;
+}
+
+void printUsage()
+{
+  std::cout << "Usage: hfl_emulator [options]\n"
+            << "  --sensors N        emulated sensors (1)\n"
+            << "  --rate HZ          frames per second per sensor (25)\n"
+            << "  --duration S       seconds to run, 0 until interrupted (10)\n"
+            << "  --loss P           probability a datagram is dropped (0)\n"
+            << "  --reorder P        probability a frame row swaps with the next (0)\n"
+            << "  --source IP        source address of the first sensor (127.0.0.10)\n"
+            << "  --destination IP   driver address (127.0.0.1)\n"
+            << "  --frame-port PORT  frame port of the first sensor, others follow (57410)\n"
+            << "  --port-stride N    port offset between sensors (10)\n";
+}
+
+bool parseOptions(int argc, char** argv, EmulatorOptions& options)
+{
+  for (int i = 1; i < argc; i += 1)
+  {
+    std::string name = argv[i];
+    if (name == "--help" || i + 1 >= argc)
+    {
+      return false;
+    }
+    std::string value = argv[++i];
+    if (name == "--sensors")
+      options.sensors = std::atoi(value.c_str());
+    else if (name == "--rate")
+      options.rate = std::atof(value.c_str());
+    else if (name == "--duration")
+      options.duration = std::atof(value.c_str());
+    else if (name == "--loss")
+      options.loss = std::atof(value.c_str());
+    else if (name == "--reorder")
+      options.reorder = std::atof(value.c_str());
+    else if (name == "--source")
+      options.source = value;
+    else if (name == "--destination")
+      options.destination = value;
+    else if (name == "--frame-port")
+      options.frame_port = std::atoi(value.c_str());
+    else if (name == "--port-stride")
+      options.port_stride = std::atoi(value.c_str());
+    else
+      return false;
+  }
+  return options.sensors > 0 && options.rate > 0.0;
+}
+
+/// Synthetic scene: a tilted wall with a box in front of it
+void buildScene(int sensor, std::vector<hfl::FrameRowData>& rows)
+{
+  rows.resize(EMULATOR_ROWS);
+  for (uint32_t row = 0; row < EMULATOR_ROWS; row += 1)
+  {
+    hfl::FrameRowData& data = rows[row];
+    for (size_t col = 0; col < hfl::ENCODER_COLUMNS; col += 1)
+    {
+      float wall = 10.0f + 0.05f * col + 0.5f * sensor;
+      bool box = (col > 50 && col < 70 && row > 10 && row < 24);
+      float range = box ? 5.0f : wall;
+      data.range[col][0] = uint16_t(range * 256);
+      data.range[col][1] = box ? uint16_t(wall * 256) : 0xffff;
+      data.intensity[col][0] = uint16_t(1000 + 20 * row + col);
+      data.intensity[col][1] = box ? 200 : 0;
+      data.flags[col] = (col % 64 == 0) ? 0x02 : 0x00;
+    }
+  }
+}
+
+void runSensor(int sensor, const EmulatorOptions& options, EmulatorStats& stats)
+{
+  int socket_fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (socket_fd < 0)
+  {
+    std::cout << "[ERROR] sensor " << sensor << " socket not created: " << strerror(errno) << std::endl;
+    return;
+  }
+
+  // Send from a distinct loopback address per sensor
+  sockaddr_in source{};
+  source.sin_family = AF_INET;
+  source.sin_addr.s_addr = htonl(ntohl(inet_addr(options.source.c_str())) + sensor);
+  if (bind(socket_fd, reinterpret_cast<sockaddr*>(&source), sizeof(source)) < 0)
+  {
+    std::cout << "[ERROR] sensor " << sensor << " source address not bound: " << strerror(errno)
+              << std::endl;
+    close(socket_fd);
+    return;
+  }
+
+  // Ports in the order frame, pdm, object, tele, slice
+  int frame_port = options.frame_port + sensor * options.port_stride;
+  sockaddr_in destinations[hfl::channel_count];
+  for (int channel = 0; channel < hfl::channel_count; channel += 1)
+  {
+    destinations[channel] = sockaddr_in{};
+    destinations[channel].sin_family = AF_INET;
+    destinations[channel].sin_addr.s_addr = inet_addr(options.destination.c_str());
+    destinations[channel].sin_port = htons(frame_port + channel);
+  }
+
+  // Rows only change in their header from frame to frame, encode them once
+  hfl::PacketEncoder encoder;
+  std::vector<hfl::FrameRowData> scene;
+  buildScene(sensor, scene);
+  std::vector<hfl::PacketBuffer> rows(EMULATOR_ROWS);
+  for (uint32_t row = 0; row < EMULATOR_ROWS; row += 1)
+  {
+    // Row 31 of the image is sent first
+    encoder.encodeFrameRow(rows[row], 0, row, 0, scene[EMULATOR_ROWS - 1 - row]);
+  }
+
+  hfl::PacketBuffer objects_first, objects_second, telemetry, slice;
+  std::vector<hfl::EncodedObject> objects(hfl::OBJECTS_FIRST_PACKET + hfl::OBJECTS_SECOND_PACKET);
+  std::string serial = "EMU" + std::to_string(sensor);
+
+  std::mt19937 random(sensor + 1);
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  mmsghdr messages[EMULATOR_ROWS];
+  iovec iovecs[EMULATOR_ROWS];
+  std::vector<uint32_t> order(EMULATOR_ROWS);
+
+  auto period = std::chrono::nanoseconds(int64_t(1e9 / options.rate));
+  auto start = std::chrono::steady_clock::now();
+  auto next_frame = start;
+  auto next_telemetry = start;
+  for (uint32_t frame_number = 0; running; frame_number += 1)
+  {
+    auto now = std::chrono::steady_clock::now();
+    if (options.duration > 0 && now - start >= std::chrono::duration<double>(options.duration))
+    {
+      break;
+    }
+    uint64_t sensor_time = std::chrono::duration_cast<std::chrono::microseconds>(
+      now.time_since_epoch()).count();
+
+    // Row order with loss and adjacent swaps
+    order.clear();
+    for (uint32_t row = 0; row < EMULATOR_ROWS; row += 1)
+    {
+      if (uniform(random) < options.loss)
+      {
+        stats.lost += 1;
+        continue;
+      }
+      order.push_back(row);
+    }
+    for (size_t i = 0; i + 1 < order.size(); i += 1)
+    {
+      if (uniform(random) < options.reorder)
+      {
+        std::swap(order[i], order[i + 1]);
+        i += 1;
+      }
+    }
+
+    memset(messages, 0, sizeof(messages));
+    for (size_t i = 0; i < order.size(); i += 1)
+    {
+      hfl::PacketBuffer& buffer = rows[order[i]];
+      hfl::PacketEncoder::setFrameHeader(buffer, frame_number, sensor_time);
+      iovecs[i].iov_base = buffer.data;
+      iovecs[i].iov_len = buffer.size;
+      messages[i].msg_hdr.msg_iov = &iovecs[i];
+      messages[i].msg_hdr.msg_iovlen = 1;
+      messages[i].msg_hdr.msg_name = &destinations[hfl::channel_frame];
+      messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+    }
+    int sent = order.empty() ? 0 : sendmmsg(socket_fd, messages, order.size(), 0);
+    if (sent < 0)
+    {
+      stats.errors += 1;
+    }
+    else
+    {
+      stats.sent += sent;
+    }
+
+    // Objects moving along the wall, sent in two packets
+    for (size_t i = 0; i < objects.size(); i += 1)
+    {
+      objects[i].x = 5.0f + i;
+      objects[i].y = std::sin(0.1f * frame_number + i);
+      objects[i].length = 4.0f;
+      objects[i].width = 1.8f;
+      objects[i].height = 1.5f;
+      objects[i].vx = 0.1f * options.rate * std::cos(0.1f * frame_number + i);
+      objects[i].classification = i % 4;
+      objects[i].confidence = 90;
+    }
+    encoder.encodeObjects(objects_first, &objects[0], hfl::OBJECTS_FIRST_PACKET, false);
+    encoder.encodeObjects(objects_second, &objects[hfl::OBJECTS_FIRST_PACKET],
+                          hfl::OBJECTS_SECOND_PACKET, true);
+    encoder.encodeSlice(slice, frame_number, sensor_time);
+    hfl::PacketBuffer* packets[] = { &objects_first, &objects_second, &slice };
+    hfl::packet_channel channels[] = { hfl::channel_object, hfl::channel_object, hfl::channel_slice };
+    for (size_t i = 0; i < 3; i += 1)
+    {
+      if (uniform(random) < options.loss)
+      {
+        stats.lost += 1;
+        continue;
+      }
+      if (sendto(socket_fd, packets[i]->data, packets[i]->size, 0,
+                 reinterpret_cast<sockaddr*>(&destinations[channels[i]]), sizeof(sockaddr_in)) < 0)
+      {
+        stats.errors += 1;
+      }
+      else
+      {
+        stats.sent += 1;
+      }
+    }
+
+    // Telemetry once per second
+    if (now >= next_telemetry)
+    {
+      encoder.encodeTelemetry(telemetry, frame_number, 40.0f + sensor, serial);
+      if (sendto(socket_fd, telemetry.data, telemetry.size, 0,
+                 reinterpret_cast<sockaddr*>(&destinations[hfl::channel_tele]), sizeof(sockaddr_in)) < 0)
+      {
+        stats.errors += 1;
+      }
+      else
+      {
+        stats.sent += 1;
+      }
+      next_telemetry += std::chrono::seconds(1);
+    }
+
+    stats.frames += 1;
+    next_frame += period;
+    std::this_thread::sleep_until(next_frame);
+  }
+  close(socket_fd);
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  EmulatorOptions options;
+  if (!parseOptions(argc, argv, options))
+  {
+    printUsage();
+    return 1;
+  }
+  signal(SIGINT, stopEmulator);
+
+  std::vector<EmulatorStats> stats(options.sensors);
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (int sensor = 0; sensor < options.sensors; sensor += 1)
+  {
+    threads.push_back(std::thread(runSensor, sensor, std::cref(options), std::ref(stats[sensor])));
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  for (int sensor = 0; sensor < options.sensors; sensor += 1)
+  {
+    std::cout << "sensor " << sensor << ": " << stats[sensor].frames << " frames ("
+              << stats[sensor].frames / elapsed << " Hz), " << stats[sensor].sent << " datagrams sent, "
+              << stats[sensor].lost << " dropped on purpose, " << stats[sensor].errors
+              << " send errors" << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,171 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// @file hfl_row_benchmark.cpp
+///
+/// @brief This file implements the frame row decoder benchmark.
+///
+/// Decodes the ranges and flags of synthetic frame rows with every kernel the
+/// CPU supports and reports the time per row and the speedup over the scalar
+/// kernel.
+///
+#include <packet_encoder.h>
+#include <range_table.h>
+#include <row_decoder.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+/// Distinct rows decoded in turn, so the input is not a single cached row
+const size_t BENCHMARK_ROWS{ 32 };
+
+/// Returns the average time of one kernel call per row in nanoseconds
+template <typename Kernel>
+double benchmarkKernel(Kernel kernel, const std::vector<hfl::PacketBuffer>& rows, size_t iterations)
+{
+  // Warm up caches and branch predictors
+  for (size_t i = 0; i < rows.size(); i += 1)
+  {
+    kernel(&rows[i].data[hfl::FRAME_DATA_OFFSET]);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; i += 1)
+  {
+    kernel(&rows[i % rows.size()].data[hfl::FRAME_DATA_OFFSET]);
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+/// Prints one result line, speedup relative to the scalar time
+void printResult(const char* isa, const char* stage, double time, double scalar_time)
+{
+  std::cout << std::left << std::setw(10) << isa << std::setw(14) << stage << std::right
+            << std::fixed << std::setprecision(1) << std::setw(12) << time
+            << std::setprecision(2) << std::setw(11) << scalar_time / time << "x" << std::endl;
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+  if (iterations == 0)
+  {
+    std::cout << "Usage: hfl_row_benchmark [iterations]" << std::endl;
+    return 1;
+  }
+
+  // Random ranges, about a fifth of them beyond the cutoff
+  std::mt19937 generator(1);
+  std::uniform_int_distribution<int> word(0, 65535);
+  hfl::PacketEncoder encoder;
+  hfl::FrameRowData row_data;
+  std::vector<hfl::PacketBuffer> rows(BENCHMARK_ROWS);
+  for (size_t row = 0; row < rows.size(); row += 1)
+  {
+    for (size_t col = 0; col < hfl::ENCODER_COLUMNS; col += 1)
+    {
+      row_data.range[col][0] = uint16_t(word(generator));
+      row_data.range[col][1] = uint16_t(word(generator));
+      row_data.intensity[col][0] = uint16_t(word(generator));
+      row_data.intensity[col][1] = uint16_t(word(generator));
+      row_data.flags[col] = uint8_t(word(generator));
+    }
+    encoder.encodeFrameRow(rows[row], 0, uint32_t(row), 0, row_data);
+  }
+
+  std::vector<float> range_1(hfl::ROW_COLUMNS), range_2(hfl::ROW_COLUMNS);
+  std::vector<uint16_t> intensity_1(hfl::ROW_COLUMNS), intensity_2(hfl::ROW_COLUMNS);
+  hfl::DecodedRow out;
+  out.range_1 = range_1.data();
+  out.range_2 = range_2.data();
+  out.intensity_1 = intensity_1.data();
+  out.intensity_2 = intensity_2.data();
+
+  std::vector<uint8_t> flag_planes(6 * hfl::ROW_COLUMNS);
+  hfl::DecodedFlags flags;
+  flags.crosstalk = &flag_planes[0 * hfl::ROW_COLUMNS];
+  flags.saturated = &flag_planes[1 * hfl::ROW_COLUMNS];
+  flags.superimposed = &flag_planes[2 * hfl::ROW_COLUMNS];
+  flags.crosstalk_2 = &flag_planes[3 * hfl::ROW_COLUMNS];
+  flags.saturated_2 = &flag_planes[4 * hfl::ROW_COLUMNS];
+  flags.superimposed_2 = &flag_planes[5 * hfl::ROW_COLUMNS];
+  std::vector<uint8_t> flag_bits(8 * hfl::ROW_FLAG_PLANE_SIZE);
+
+  hfl::RangeTable range_table;
+
+  const hfl::row_decoder_isa kernels[] = { hfl::isa_scalar, hfl::isa_sse41, hfl::isa_avx2 };
+  double scalar_decode = 0.0, scalar_unpack = 0.0, scalar_pack = 0.0;
+  std::cout << std::left << std::setw(10) << "kernel" << std::setw(14) << "stage" << std::right
+            << std::setw(12) << "ns/row" << std::setw(12) << "speedup" << std::endl;
+  for (hfl::row_decoder_isa isa : kernels)
+  {
+    const char* name = hfl::RowDecoder::getIsaName(isa);
+    if (!hfl::RowDecoder::isSupported(isa))
+    {
+      std::cout << std::left << std::setw(10) << name << std::setw(14) << "-" << std::right
+                << std::setw(12) << "n/a" << std::endl;
+      continue;
+    }
+    hfl::RowDecoder decoder(isa);
+    double decode = benchmarkKernel(
+      [&](const uint8_t* data) {
+        hfl::RangeTable::Reader range(range_table);
+        decoder.decode(data, range.get(), out);
+      },
+      rows, iterations);
+    double unpack = benchmarkKernel(
+      [&](const uint8_t* data) { decoder.unpackFlags(data + hfl::ROW_FLAG_OFFSET, flags); }, rows,
+      iterations);
+    double pack = benchmarkKernel(
+      [&](const uint8_t* data) { decoder.packFlags(data + hfl::ROW_FLAG_OFFSET, flag_bits.data()); },
+      rows, iterations);
+    if (isa == hfl::isa_scalar)
+    {
+      scalar_decode = decode;
+      scalar_unpack = unpack;
+      scalar_pack = pack;
+    }
+    printResult(name, "range", decode, scalar_decode);
+    printResult(name, "flag planes", unpack, scalar_unpack);
+    printResult(name, "flag bits", pack, scalar_pack);
+  }
+  std::cout << "Driver kernel: " << hfl::RowDecoder::getIsaName(hfl::RowDecoder().getIsa())
+            << std::endl;
+  return 0;
+}
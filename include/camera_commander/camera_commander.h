@@ -38,10 +38,14 @@
 
 #include <hfl_driver/HFLConfig.h>
 #include <hfl_interface.h>
+#include <packet_recorder.h>
+#include <udp_receiver.h>
 
+#include <diagnostic_updater/diagnostic_updater.h>
 #include <dynamic_reconfigure/server.h>
 #include <nodelet/nodelet.h>
 
+#include <atomic>
 #include <vector>
 #include <string>
 #include <memory>
@@ -116,6 +120,13 @@ public:
   ///
   bool udpInit();
 
+  ///
+  /// Initialize the native UDP receiver, bypassing udp_com
+  ///
+  /// @return bool true if all sensor ports are open
+  ///
+  bool nativeUdpInit();
+
   ///
   /// Create Socket Request Function
   ///
@@ -163,10 +174,10 @@ private:
   ros::Timer timer_;
 
   /// Commander current state
-  commander_states current_state_;
+  std::atomic<commander_states> current_state_;
 
   /// Commander Previous state prior to error
-  commander_states previous_state_;
+  std::atomic<commander_states> previous_state_;
 
   /// Error Status
   error_codes error_status_;
@@ -195,6 +206,18 @@ private:
   /// Slice Data UDP port
   int slice_data_port_;
   
+  /// Flag for reading the sensor sockets directly instead of through udp_com
+  bool native_udp_{false};
+
+  /// Native UDP receivers, one per sensor port
+  std::vector<std::shared_ptr<hfl::UdpReceiver>> udp_receivers_;
+
+  /// Native UDP ingest diagnostics
+  std::shared_ptr<diagnostic_updater::Updater> ingest_updater_;
+
+  /// Raw packet recorder, null unless record_file is set
+  std::shared_ptr<hfl::PacketRecorder> recorder_;
+
   /// Pointer to Flash camera
   std::shared_ptr<hfl::HflInterface> flash_;
 
@@ -233,6 +256,51 @@ private:
   ///
   void frameDataCallback(const udp_com::UdpPacket& udp_packet);
 
+  ///
+  /// Handles frame data from the sensor
+  ///
+  /// @param[in] data frame data
+  ///
+  /// @return void
+  ///
+  void handleFrameData(hfl::PacketView data);
+
+  ///
+  /// Handles PDM data from the sensor
+  ///
+  /// @param[in] data pdm data
+  ///
+  /// @return void
+  ///
+  void handlePdmData(hfl::PacketView data);
+
+  ///
+  /// Handles object data from the sensor
+  ///
+  /// @param[in] data object data
+  ///
+  /// @return void
+  ///
+  void handleObjectData(hfl::PacketView data);
+
+  ///
+  /// Handles telemetry data from the sensor
+  ///
+  /// @param[in] data telemetry data
+  ///
+  /// @return void
+  ///
+  void handleTeleData(hfl::PacketView data);
+
+  ///
+  /// Handles slice data from the sensor
+  ///
+  /// @param[in] data slice data
+  ///
+  /// @return void
+  ///
+  void handleSliceData(hfl::PacketView data);
+
   ///
   /// Callback for performance degredation module (PDM) data UDP packets
   ///
@@ -314,6 +382,15 @@ private:
   ///
 
   bool fixError(error_codes error);
+
+  ///
+  /// Fills the native UDP ingest diagnostics
+  ///
+  /// @param[out] stat diagnostic status to fill
+  ///
+  /// @return void
+  ///
+  void updateIngestDiagnostics(diagnostic_updater::DiagnosticStatusWrapper& stat);
 };
 
 }  // namespace hfl
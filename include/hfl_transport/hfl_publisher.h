@@ -0,0 +1,79 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// @file hfl_publisher.h
+///
+/// @brief This file defines the lossless hfl image transport publisher.
+///
+#ifndef HFL_TRANSPORT__HFL_PUBLISHER_H_
+#define HFL_TRANSPORT__HFL_PUBLISHER_H_
+
+#include <image_transport/simple_publisher_plugin.h>
+#include <sensor_msgs/CompressedImage.h>
+
+#include <string>
+
+namespace hfl
+{
+/// Format suffix of compressed images, after the image encoding
+const std::string HFL_TRANSPORT_FORMAT = "; hfl compressed";
+
+///
+/// @brief Publishes depth and intensity images compressed without loss.
+///
+/// Accepts 32FC1 range and 16 bit images, see DepthCodec. Subscribers of
+/// the hfl transport get back the exact images that were published.
+///
+class HFLPublisher : public image_transport::SimplePublisherPlugin<sensor_msgs::CompressedImage>
+{
+public:
+  ///
+  /// Returns the transport name, the topic suffix
+  ///
+  /// @return std::string "hfl"
+  ///
+  std::string getTransportName() const override
+  {
+    return "hfl";
+  }
+
+protected:
+  ///
+  /// Compress an image and publish it
+  ///
+  /// @param[in] message image to publish
+  /// @param[in] publish_fn publishes the compressed image
+  ///
+  void publish(const sensor_msgs::Image& message, const PublishFn& publish_fn) const override;
+};
+}  // namespace hfl
+
+#endif  // HFL_TRANSPORT__HFL_PUBLISHER_H_
@@ -0,0 +1,73 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// @file hfl_subscriber.h
+///
+/// @brief This file defines the lossless hfl image transport subscriber.
+///
+#ifndef HFL_TRANSPORT__HFL_SUBSCRIBER_H_
+#define HFL_TRANSPORT__HFL_SUBSCRIBER_H_
+
+#include <image_transport/simple_subscriber_plugin.h>
+#include <sensor_msgs/CompressedImage.h>
+
+#include <string>
+
+namespace hfl
+{
+///
+/// @brief Decompresses images published by HFLPublisher.
+///
+class HFLSubscriber : public image_transport::SimpleSubscriberPlugin<sensor_msgs::CompressedImage>
+{
+public:
+  ///
+  /// Returns the transport name, the topic suffix
+  ///
+  /// @return std::string "hfl"
+  ///
+  std::string getTransportName() const override
+  {
+    return "hfl";
+  }
+
+protected:
+  ///
+  /// Decompress an image and pass it on
+  ///
+  /// @param[in] message compressed image
+  /// @param[in] user_cb receives the decompressed image
+  ///
+  void internalCallback(const sensor_msgs::CompressedImageConstPtr& message, const Callback& user_cb) override;
+};
+}  // namespace hfl
+
+#endif  // HFL_TRANSPORT__HFL_SUBSCRIBER_H_
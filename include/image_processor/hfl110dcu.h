@@ -37,6 +37,17 @@
 #define IMAGE_PROCESSOR__HFL110DCU_H_
 
 #include <base_hfl110dcu.h>
+#include <bounded_queue.h>
+#include <calibration_monitor.h>
+#include <clock_sync.h>
+#include <decoder_registry.h>
+#include <frame_buffer.h>
+#include <frame_reassembler.h>
+#include <message_pool.h>
+#include <packed_frame.h>
+#include <packet_layout.h>
+#include <point_projector.h>
+#include <row_decoder.h>
 
 #include <angles/angles.h>
 #include <arpa/inet.h>
@@ -51,17 +62,21 @@
 #include <tf2_ros/transform_broadcaster.h>
 #include <geometry_msgs/Point.h>
 #include <std_msgs/UInt16MultiArray.h>
+#include <sensor_msgs/Image.h>
 #include <sensor_msgs/PointCloud2.h>
 #include <sensor_msgs/point_cloud2_iterator.h>
 #include <visualization_msgs/Marker.h>
 #include <visualization_msgs/MarkerArray.h>
 #include <diagnostic_updater/diagnostic_updater.h>
 #include <diagnostic_updater/publisher.h>
+#include <hfl_driver/PackedFrame.h>
 
 #include <string>
 #include <vector>
 #include <cmath>
 #include <memory>
+#include <atomic>
+#include <thread>
 
 #include "ros/ros.h"
 
@@ -72,6 +87,44 @@ const float NO_RETURN_DISTANCES = NAN;
 
 namespace hfl
 {
+/// Processing stages reported to the stage profiler
+enum frame_stage
+{
+  stage_reassembly = 0,
+  stage_row_decode,
+  stage_image_publish,
+  stage_projection,
+  stage_cloud_publish,
+  stage_object_decode,
+  stage_count
+};
+
+/// Outputs that are only built while someone subscribes to them
+enum frame_output
+{
+  /// Depth and intensity images of both returns
+  output_ranges = 1 << 0,
+  /// Classification flag images
+  output_flags = 1 << 1,
+  /// Point cloud
+  output_points = 1 << 2,
+  /// Object markers
+  output_objects = 1 << 3,
+  output_all = output_ranges | output_flags | output_points | output_objects,
+  /// Packed frame, only built if publish_packed_frame is set
+  output_packed = 1 << 4
+};
+
+/// Frames of messages allocated up front by the message pools
+const size_t MESSAGE_POOL_FRAMES{ 4 };
+/// Default number of completed frames waiting for the publisher thread
+const int PUBLISH_QUEUE_FRAMES{ 2 };
+
+/// Stage names, indexed by frame_stage
+const std::vector<std::string> FRAME_STAGE_NAMES = {
+  "reassembly", "row decode", "image publish", "projection", "cloud publish", "object decode"
+};
+
 /// @brief HFL110DCU v1 frame struct
 struct PointCloudReturn
 {
@@ -119,6 +172,11 @@ struct CameraExtrinsics
   uint32_t status;
 };
 
+static_assert(sizeof(CameraIntrinsics) == FrameLayoutV1::IntrinsicYaw::offset - FrameLayoutV1::Fx::offset,
+              "CameraIntrinsics does not match the frame packet layout");
+static_assert(sizeof(CameraExtrinsics) == FrameLayoutV1::Calibration::end - FrameLayoutV1::IntrinsicYaw::offset,
+              "CameraExtrinsics does not match the frame packet layout");
+
 /// @brief HFL110DCU v1 ethernet frame struct
 struct UdpFrame
 {
@@ -223,6 +281,90 @@ struct telemetry
   char au8SerialNumber[26];
 };
 
+/// @brief Images of one frame under reassembly
+struct FrameSlot
+{
+  /// Arrival time of the first row
+  ros::Time stamp;
+
+  /// Sensor timestamp of the first row in sensor clock ticks
+  uint64_t sensor_time;
+
+  /// Outputs built for this frame, frame_output bits fixed when it starts
+  uint32_t outputs;
+
+  /// Locates the rows of every plane, planes are bound to images
+  std::shared_ptr<FrameBuffer> buffer;
+
+  /// Image of each plane, rows are decoded straight into them. Taken from
+  /// the image pools when the frame starts and handed over on publish
+  sensor_msgs::ImagePtr images[plane_count];
+
+  /// Points of both returns, filled row by row as rows are decoded, taken
+  /// from the cloud pool when the frame starts and handed over on publish
+  sensor_msgs::PointCloud2Ptr cloud;
+
+  /// All channels of the frame in one message, filled row by row like the cloud
+  hfl_driver::PackedFramePtr packed;
+};
+
+/// @brief Frame port state reported by diagnostics, which run on the telemetry
+/// port's thread. Written by the frame port after every packet
+struct FrameDiagnostics
+{
+  /// Frame reassembly counters
+  std::atomic<uint64_t> frames_completed{ 0 };
+  std::atomic<uint64_t> frames_evicted{ 0 };
+  std::atomic<uint64_t> late_rows{ 0 };
+  std::atomic<uint64_t> duplicate_rows{ 0 };
+
+  /// Sensor clock offset in seconds, drift and resets
+  std::atomic<double> clock_offset{ 0.0 };
+  std::atomic<double> clock_drift{ 0.0 };
+  std::atomic<uint64_t> clock_resets{ 0 };
+
+  /// Calibration epoch and block hash
+  std::atomic<uint32_t> calibration_epoch{ 0 };
+  std::atomic<uint64_t> calibration_hash{ 0 };
+};
+
+/// @brief Messages of one completed frame, published together
+struct FramePublication
+{
+  /// Monotonic time the frame was handed to the publisher in nanoseconds
+  uint64_t handoff_time;
+
+  /// Outputs built for the frame, frame_output bits
+  uint32_t outputs;
+
+  /// Image of each plane and row validity image, null unless partial frames are published
+  sensor_msgs::ImagePtr images[plane_count];
+  sensor_msgs::ImagePtr row_valid;
+
+  /// Camera info of the frame's calibration epoch, stamped like the images
+  sensor_msgs::CameraInfoPtr camera_info;
+
+  /// Point cloud
+  sensor_msgs::PointCloud2Ptr cloud;
+
+  /// Packed frame
+  hfl_driver::PackedFramePtr packed;
+
+  /// Sensor pose
+  geometry_msgs::TransformStamped transform;
+};
+
+class HFL110DCU;
+
+/// @brief Packet decoders of one HFL110DCU firmware version
+struct HFL110DCUDecoders
+{
+  bool (HFL110DCU::*frame)(PacketView data);
+  bool (HFL110DCU::*object)(PacketView data);
+  bool (HFL110DCU::*telemetry)(PacketView data);
+  bool (HFL110DCU::*slice)(PacketView data);
+};
+
 ///
 /// @brief Implements the HFL110DCU camera image parsing and publishing.
 ///
@@ -240,6 +382,11 @@ public:
   HFL110DCU(std::string model, std::string version,
             std::string frame_id, ros::NodeHandle& node_handler);
 
+  ///
+  /// HFL110DCU destructor, publishes queued frames and stops the publisher thread
+  ///
+  ~HFL110DCU();
+
   ///
   /// Parse out the packet data into depth and intensity images
   ///
@@ -247,7 +394,7 @@ public:
   ///
   /// @return bool true if successfully parsed packet
   ///
-  bool parseFrame(int start_byte, const std::vector<uint8_t>& packet) override;
+  bool parseFrame(int start_byte, PacketView packet) override;
 
   ///
   /// Process data frame from udp packets.
@@ -256,7 +403,7 @@ public:
   ///
   /// @return bool true if successful
   ///
-  bool processFrameData(const std::vector<uint8_t>& data) override;
+  bool processFrameData(PacketView data) override;
 
   ///
   /// Parse out pdm data from packet
@@ -274,7 +421,7 @@ public:
   ///
   /// @return bool true if successful
   ///
-  //bool processPDMData(const std::vector<uint8_t>& data) override;
+  //bool processPDMData(PacketView data) override;
   
   ///
   /// Parse packet into objects
@@ -283,7 +430,7 @@ public:
   ///
   /// @return bool true if successfully parsed object data
   ///
-  bool parseObjects(int start_byte, const std::vector<uint8_t>& packet) override;
+  bool parseObjects(int start_byte, PacketView packet) override;
 
   ///
   /// Process the object data from udp packets
@@ -292,7 +439,7 @@ public:
   ///
   /// @return bool
   ///
-  bool processObjectData(const std::vector<uint8_t>& data) override;
+  bool processObjectData(PacketView data) override;
 
   ///
   /// Process the telemetry data from udp packets
@@ -301,7 +448,7 @@ public:
   ///
   /// @return bool
   ///
-  bool processTelemetryData(const std::vector<uint8_t>& data) override;
+  bool processTelemetryData(PacketView data) override;
   
   ///
   /// Process the slice data from udp packets
@@ -310,7 +457,7 @@ public:
   ///
   /// @return bool
   ///
-  bool processSliceData(const std::vector<uint8_t>& data) override;
+  bool processSliceData(PacketView data) override;
   
   ///
   cv::Mat initTransform(cv::Mat cameraMatrix, cv::Mat distCoeffs,
@@ -320,6 +467,142 @@ public:
   void update_diagnostics(diagnostic_updater::DiagnosticStatusWrapper &stat);
 
 private:
+  ///
+  /// Returns the decoders of all supported firmware versions
+  ///
+  /// @return const DecoderRegistry<HFL110DCUDecoders>& decoder registry
+  ///
+  static const DecoderRegistry<HFL110DCUDecoders>& getDecoders();
+
+  ///
+  /// Process v1 frame, object, telemetry and slice packets
+  ///
+  /// @param[in] data packet data
+  ///
+  /// @return bool true if successful
+  ///
+  bool processFrameDataV1(PacketView data);
+  bool processObjectDataV1(PacketView data);
+  bool processTelemetryDataV1(PacketView data);
+  bool processSliceDataV1(PacketView data);
+
+  ///
+  /// Copy the frame port state diagnostics report into frame_diagnostics_
+  ///
+  void updateFrameDiagnostics();
+
+  ///
+  /// Drops packets of firmware versions without a decoder
+  ///
+  /// @return bool always false
+  ///
+  bool ignorePacket(PacketView data);
+
+  ///
+  /// Returns the kernel receive time of a packet, the current time if unknown
+  ///
+  /// @param[in] packet received packet
+  ///
+  /// @return ros::Time receive time
+  ///
+  ros::Time receiveStamp(PacketView packet);
+
+  ///
+  /// Allocate the frame buffer of a slot
+  ///
+  /// @param[in] slot frame slot to initialize
+  ///
+  void initFrameSlot(FrameSlot& slot);
+
+  ///
+  /// Set the size and point fields of a cloud created by the cloud pool
+  ///
+  /// @param[out] cloud point cloud to initialize
+  ///
+  static void initCloud(sensor_msgs::PointCloud2& cloud);
+
+  ///
+  /// Set the size and plane offsets of a packed frame created by the packed frame pool
+  ///
+  /// @param[out] packed packed frame to initialize
+  ///
+  void initPackedFrame(hfl_driver::PackedFrame& packed) const;
+
+  ///
+  /// Take the images, cloud and packed frame of a new frame from the pools
+  /// and bind the frame buffer planes to the images
+  ///
+  /// @param[in] slot frame slot starting a frame
+  ///
+  void acquireMessages(FrameSlot& slot);
+
+  ///
+  /// Work out which outputs have subscribers, called when subscribers
+  /// connect or disconnect
+  ///
+  void updateOutputs();
+
+  ///
+  /// Hand the images, cloud and packed frame of a completed frame over for publishing
+  ///
+  /// @param[in] slot completed frame slot, no longer writes into the messages
+  /// @param[out] publication receives the messages
+  ///
+  void releaseMessages(FrameSlot& slot, FramePublication& publication);
+
+  ///
+  /// Publish the messages of a frame
+  ///
+  /// @param[in] publication messages to publish
+  /// @param[in] timer stage timer, only used on the decode thread
+  ///
+  void publishMessages(const FramePublication& publication, StageTimer& timer);
+
+  ///
+  /// Publisher thread, publishes queued frames until the queue is closed
+  ///
+  void publishLoop();
+
+  ///
+  /// Update camera info, transform and rays if the calibration of a frame
+  /// packet changed, and publish the change
+  ///
+  /// @param[in] frame_data frame packet carrying calibration
+  ///
+  void updateCalibration(PacketView frame_data);
+
+  ///
+  /// Start a new camera info pool whose messages carry a calibration
+  ///
+  /// @param[in] info camera info of the calibration, header is ignored
+  ///
+  void updateCameraInfo(const sensor_msgs::CameraInfo& info);
+
+  ///
+  /// Set rows that were not received to NaN depth and zero intensity/flags
+  ///
+  /// @param[in] slot frame slot to fill
+  /// @param[in] row_mask bit i set if row i was received
+  ///
+  void fillMissingRows(FrameSlot& slot, uint32_t row_mask);
+
+  ///
+  /// Project a decoded row into the points of its frame
+  ///
+  /// @param[in] slot frame slot holding the row
+  /// @param[in] row row index
+  ///
+  void projectRow(FrameSlot& slot, int row);
+
+  ///
+  /// Publish images, pointcloud and transform of a frame, through the
+  /// publisher thread if there is one
+  ///
+  /// @param[in] slot frame slot to publish
+  /// @param[in] row_mask bit i set if row i was received
+  ///
+  void publishFrame(FrameSlot& slot, uint32_t row_mask);
+
   /// ROS node handler
   ros::NodeHandle node_handler_;
 
@@ -347,45 +630,46 @@ private:
   /// Row and column Counter
   uint8_t row_, col_;
 
-  /// Return counter
-  uint8_t expected_packet_ = 0;
-
   /// Focal Length
   float focal_length_;
 
   // Camera info manager
   camera_info_manager::CameraInfoManager *camera_info_manager_;
 
-  /// Pointer to depth image
-  cv_bridge::CvImagePtr p_image_depth_;
+  /// Reassembles rows of concurrent frames
+  std::shared_ptr<FrameReassembler> reassembler_;
 
-  /// Pointer to 16 bit intensity image
-  cv_bridge::CvImagePtr p_image_intensity_;
+  /// Images of frames under reassembly, indexed by reassembler slot
+  std::vector<FrameSlot> frame_slots_;
 
-  /// Pointer to depth image second return
-  cv_bridge::CvImagePtr p_image_depth2_;
+  /// Slot of the row currently being parsed
+  FrameSlot* slot_;
+
+  /// Publish incomplete frames when they are evicted
+  bool publish_partial_frames_;
+
+  /// Stamp of the last published frame in nanoseconds, read by the object port
+  std::atomic<uint64_t> frame_stamp_;
+
+  /// Outputs with subscribers, frame_output bits
+  std::atomic<uint32_t> outputs_;
+
+  /// Build outputs only while subscribed, set once all publishers exist
+  std::atomic<bool> lazy_outputs_;
+
+  /// Stamp frames with the synchronized sensor time instead of the receive time,
+  /// set in the constructor before any port thread starts
+  bool clock_sync_enabled_;
+
+  /// Maps the sensor clock to host time
+  ClockSync clock_sync_;
+
+  /// Decodes range and intensity of a row with the fastest supported kernel
+  RowDecoder row_decoder_;
+
+  /// Packet decoders of the camera's firmware version
+  HFL110DCUDecoders decoders_;
 
-  /// Pointer to 16 bit intensity image second return
-  cv_bridge::CvImagePtr p_image_intensity2_;
-  
-  /// Pointer to crosstalk flags
-  cv_bridge::CvImagePtr p_image_crosstalk_;
-  
-  /// Pointer to saturated flags
-  cv_bridge::CvImagePtr p_image_saturated_;
-  
-  /// Pointer to superimposed flags
-  cv_bridge::CvImagePtr p_image_superimposed_;
-  
-  /// Pointer to crosstalk2 flags
-  cv_bridge::CvImagePtr p_image_crosstalk2_;
-  
-  /// Pointer to saturated2 flags
-  cv_bridge::CvImagePtr p_image_saturated2_;
-  
-  /// Pointer to superimposed2 flags
-  cv_bridge::CvImagePtr p_image_superimposed2_;
-  
   /// Depth image publisher
   image_transport::CameraPublisher pub_depth_;
 
@@ -416,6 +700,12 @@ private:
   /// Superimposed flag image publisher
   image_transport::CameraPublisher pub_si2_;
 
+  /// Row validity publisher, only advertised with publish_partial_frames
+  image_transport::CameraPublisher pub_row_valid_;
+
+  /// Packed frame publisher, only advertised with publish_packed_frame
+  ros::Publisher pub_packed_;
+
   /// Objects publisher
   ros::Publisher pub_objects_;
   
@@ -431,9 +721,6 @@ private:
   /// Telemetry Data
   telemetry telem_{};
 
-  /// Pointcloud msg
-  std::shared_ptr<sensor_msgs::PointCloud2> pointcloud_;
-
   /// Slices msg
   std::shared_ptr<std_msgs::UInt16MultiArray> slices_;
   
@@ -443,6 +730,54 @@ private:
   /// Transform
   cv::Mat transform_;
 
+  /// Projects decoded rows along the rays of transform_
+  PointProjector projector_;
+
+  /// Detects calibration changes between frames
+  CalibrationMonitor calibration_monitor_;
+
+  /// Calibration change publisher, latched
+  ros::Publisher pub_calibration_;
+
+  /// Recycled images of each plane, returned when the last subscriber releases them
+  std::vector<std::shared_ptr<MessagePool<sensor_msgs::Image>>> image_pools_;
+
+  /// Recycled row validity images
+  MessagePool<sensor_msgs::Image> row_valid_pool_;
+
+  /// Recycled point cloud messages
+  MessagePool<sensor_msgs::PointCloud2> cloud_pool_;
+
+  /// Plane offsets of the packed frame
+  PackedFrameLayout packed_layout_;
+
+  /// Recycled camera infos of the current calibration epoch, filled once when
+  /// created and only restamped per frame. Replaced on calibration change,
+  /// messages of earlier epochs return to their own pool
+  std::unique_ptr<MessagePool<sensor_msgs::CameraInfo>> camera_info_pool_;
+
+  /// Camera infos created up front by each camera info pool
+  size_t camera_info_pool_size_;
+
+  /// Recycled packed frames, null unless publish_packed_frame is set
+  std::unique_ptr<MessagePool<hfl_driver::PackedFrame>> packed_pool_;
+
+  /// Completed frames waiting for the publisher thread, null if frames are
+  /// published on the decode thread
+  std::unique_ptr<BoundedQueue<FramePublication>> publish_queue_;
+
+  /// Publisher thread, serializes for remote subscribers off the decode thread
+  std::thread publish_thread_;
+
+  /// Time from hand-off to published in nanoseconds: sum, count and maximum
+  std::atomic<uint64_t> publish_latency_total_;
+  std::atomic<uint64_t> publish_count_;
+  std::atomic<uint64_t> publish_latency_max_;
+
+  /// Frame port state for diagnostics, the frame port's own state is not
+  /// synchronized
+  FrameDiagnostics frame_diagnostics_;
+
   // Diagnostic Updater
   diagnostic_updater::Updater updater_;
 
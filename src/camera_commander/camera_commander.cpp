@@ -40,6 +40,7 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <utility>
 
 #include "image_processor/hfl110dcu.h"
 namespace hfl
@@ -51,6 +52,16 @@ CameraCommander::CameraCommander()
 
 CameraCommander::~CameraCommander()
 {
+  // Stop native receivers before the camera goes away
+  for (const auto& receiver : udp_receivers_)
+  {
+    receiver->stop();
+  }
+  // Write out the recorded packets
+  if (recorder_)
+  {
+    recorder_->close();
+  }
   // Stop camera if active
   if (current_state_ != state_probe)
   {
@@ -69,14 +80,36 @@ void CameraCommander::onInit()
   {
     throw - 1;
   }
+  // Initialize current state before any packet can arrive
+  current_state_ = state_probe;
+  previous_state_ = state_probe;
+  // Start recording raw packets if requested
+  std::string record_file;
+  node_handler_.param<std::string>("record_file", record_file, "");
+  if (!record_file.empty())
+  {
+    recorder_ = std::make_shared<hfl::PacketRecorder>();
+    if (recorder_->open(record_file))
+    {
+      ROS_INFO("%s/record_file:      %s", namespace_.c_str(), record_file.c_str());
+    } else {
+      ROS_WARN("Packet recording to %s not started", record_file.c_str());
+      recorder_.reset();
+    }
+  }
   // Initialize UPD services, sockets, and subscribers
   if (!udpInit())
   {
     throw - 1;
   }
-  // Initialize current state and timer_ callback
-  current_state_ = state_probe;
-  previous_state_ = state_probe;
+  // Initialize ingest diagnostics
+  if (native_udp_ || recorder_)
+  {
+    ingest_updater_ = std::make_shared<diagnostic_updater::Updater>(node_handler_, node_handler_);
+    ingest_updater_->setHardwareIDf("%s", namespace_.c_str());
+    ingest_updater_->add("HFL110 UDP Ingest", this, &CameraCommander::updateIngestDiagnostics);
+  }
+  // Initialize timer_ callback
   auto set_state_callback =
       std::bind(&CameraCommander::setCommanderState, this, std::placeholders::_1);
   timer_ = node_handler_.createTimer(ros::Duration(1), set_state_callback);
@@ -136,7 +169,17 @@ bool CameraCommander::udpInit()
   // Get slice data port number
   node_handler_.getParam("slice_data_port", slice_data_port_);
   ROS_INFO("%s/slice_data_port:      %i", namespace_.c_str(), slice_data_port_);
-  
+
+  // Get native UDP flag
+  node_handler_.param("native_udp", native_udp_, false);
+  ROS_INFO("%s/native_udp:      %s", namespace_.c_str(), native_udp_ ? "true" : "false");
+
+  // Read the sensor sockets directly if requested
+  if (native_udp_)
+  {
+    return nativeUdpInit();
+  }
+
   // Get ethernet namespace node handler
   ros::NodeHandle ethernet_interface_handler(ethernet_interface_);
 
@@ -218,6 +261,44 @@ bool CameraCommander::udpInit()
   return true;
 }
 
+bool CameraCommander::nativeUdpInit()
+{
+  using std::placeholders::_1;
+  // Handler for every sensor port
+  std::vector<std::pair<int, hfl::UdpReceiver::Callback> > ports =
+  {
+    { frame_data_port_, std::bind(&CameraCommander::handleFrameData, this, _1) },
+    { pdm_data_port_, std::bind(&CameraCommander::handlePdmData, this, _1) },
+    { object_data_port_, std::bind(&CameraCommander::handleObjectData, this, _1) },
+    { tele_data_port_, std::bind(&CameraCommander::handleTeleData, this, _1) },
+    { slice_data_port_, std::bind(&CameraCommander::handleSliceData, this, _1) }
+  };
+
+  // Open a socket with its own receive and consumer threads per port
+  for (const auto& port : ports)
+  {
+    auto receiver = std::make_shared<hfl::UdpReceiver>(camera_address_, port.first, port.second);
+    if (!receiver->open(computer_address_))
+    {
+      ROS_WARN("Native socket for port %i not created", port.first);
+      return false;
+    }
+    udp_receivers_.push_back(receiver);
+  }
+
+  for (const auto& receiver : udp_receivers_)
+  {
+    if (!receiver->start())
+    {
+      ROS_WARN("Native UDP receiver for port %i not started", receiver->getPort());
+      return false;
+    }
+  }
+
+  ROS_INFO("Native UDP receiver online");
+  return true;
+}
+
 bool CameraCommander::setFlash()
 {
   // Parameter temporal variables
@@ -259,6 +340,11 @@ void CameraCommander::setCommanderState(const ros::TimerEvent&)
   {
     0x1C, 0x00
   };
+  // Update native ingest diagnostics
+  if (ingest_updater_)
+  {
+    ingest_updater_->update();
+  }
   // Executes states accordingly
   switch (current_state_)
   {
@@ -300,7 +386,7 @@ void CameraCommander::setCommanderState(const ros::TimerEvent&)
     case state_error:
       if (fixError(error_status_))
       {
-        current_state_ = previous_state_;
+        current_state_ = previous_state_.load();
       }
       break;
     // Default state
@@ -369,18 +455,27 @@ void CameraCommander::frameDataCallback(const udp_com::UdpPacket& udp_packet)
   // Checks UPD package source IP address
   if (udp_packet.address == camera_address_)
   {
-    switch (current_state_)
-    {
-      case state_probe:
-        ROS_INFO_ONCE("Connection established with Frame Data UDP Port!");
-        previous_state_ = state_probe;
-        current_state_ = state_init;
-        break;
-      case state_done:
-        ROS_INFO_ONCE("Frame Data UDP packages arriving...");
-        flash_->processFrameData(udp_packet.data);
-        break;
-    }
+    handleFrameData(udp_packet.data);
+  }
+}
+
+void CameraCommander::handleFrameData(hfl::PacketView data)
+{
+  if (recorder_)
+  {
+    recorder_->record(hfl::channel_frame, data);
+  }
+  switch (current_state_)
+  {
+    case state_probe:
+      ROS_INFO_ONCE("Connection established with Frame Data UDP Port!");
+      previous_state_ = state_probe;
+      current_state_ = state_init;
+      break;
+    case state_done:
+      ROS_INFO_ONCE("Frame Data UDP packages arriving...");
+      flash_->processFrameData(data);
+      break;
   }
 }
 
@@ -389,18 +484,27 @@ void CameraCommander::pdmDataCallback(const udp_com::UdpPacket& udp_packet)
   // Checks UPD package source IP address
   if (udp_packet.address == camera_address_)
   {
-    switch (current_state_)
-    {
-      case state_probe:
-        ROS_INFO_ONCE("Connection established with PDM Data UDP Port!");
-        previous_state_ = state_probe;
-        current_state_ = state_init;
-        break;
-      case state_done:
-        ROS_INFO_ONCE("PDM Data UDP packages arriving...");
-	//flash_->processPDMData(udp_packet.data);
-        break;
-    }
+    handlePdmData(udp_packet.data);
+  }
+}
+
+void CameraCommander::handlePdmData(hfl::PacketView data)
+{
+  if (recorder_)
+  {
+    recorder_->record(hfl::channel_pdm, data);
+  }
+  switch (current_state_)
+  {
+    case state_probe:
+      ROS_INFO_ONCE("Connection established with PDM Data UDP Port!");
+      previous_state_ = state_probe;
+      current_state_ = state_init;
+      break;
+    case state_done:
+      ROS_INFO_ONCE("PDM Data UDP packages arriving...");
+      //flash_->processPDMData(data);
+      break;
   }
 }
 
@@ -409,18 +513,27 @@ void CameraCommander::objectDataCallback(const udp_com::UdpPacket& udp_packet)
   // Checks UPD package source IP address
   if (udp_packet.address == camera_address_)
   {
-    switch (current_state_)
-    {
-      case state_probe:
-        ROS_INFO_ONCE("Connection established with Object Data UDP Port!");
-        previous_state_ = state_probe;
-        current_state_ = state_init;
-        break;
-      case state_done:
-        ROS_INFO_ONCE("Object Data UDP packages arriving...");
-        flash_->processObjectData(udp_packet.data);
-        break;
-    }
+    handleObjectData(udp_packet.data);
+  }
+}
+
+void CameraCommander::handleObjectData(hfl::PacketView data)
+{
+  if (recorder_)
+  {
+    recorder_->record(hfl::channel_object, data);
+  }
+  switch (current_state_)
+  {
+    case state_probe:
+      ROS_INFO_ONCE("Connection established with Object Data UDP Port!");
+      previous_state_ = state_probe;
+      current_state_ = state_init;
+      break;
+    case state_done:
+      ROS_INFO_ONCE("Object Data UDP packages arriving...");
+      flash_->processObjectData(data);
+      break;
   }
 }
 
@@ -429,18 +542,27 @@ void CameraCommander::teleDataCallback(const udp_com::UdpPacket& udp_packet)
   // Checks UPD package source IP address
   if (udp_packet.address == camera_address_)
   {
-    switch (current_state_)
-    {
-      case state_probe:
-        ROS_INFO_ONCE("Connection established with Telemetry Data UDP Port!");
-        previous_state_ = state_probe;
-        current_state_ = state_init;
-        break;
-      case state_done:
-        ROS_INFO_ONCE("Telemetry Data UDP packages arriving...");
-        flash_->processTelemetryData(udp_packet.data);
-        break;
-    }
+    handleTeleData(udp_packet.data);
+  }
+}
+
+void CameraCommander::handleTeleData(hfl::PacketView data)
+{
+  if (recorder_)
+  {
+    recorder_->record(hfl::channel_tele, data);
+  }
+  switch (current_state_)
+  {
+    case state_probe:
+      ROS_INFO_ONCE("Connection established with Telemetry Data UDP Port!");
+      previous_state_ = state_probe;
+      current_state_ = state_init;
+      break;
+    case state_done:
+      ROS_INFO_ONCE("Telemetry Data UDP packages arriving...");
+      flash_->processTelemetryData(data);
+      break;
   }
 }
 
@@ -449,17 +571,55 @@ void CameraCommander::sliceDataCallback(const udp_com::UdpPacket& udp_packet)
   // Checks UPD package source IP address
   if (udp_packet.address == camera_address_)
   {
-    switch (current_state_)
+    handleSliceData(udp_packet.data);
+  }
+}
+
+void CameraCommander::handleSliceData(hfl::PacketView data)
+{
+  if (recorder_)
+  {
+    recorder_->record(hfl::channel_slice, data);
+  }
+  switch (current_state_)
+  {
+    case state_probe:
+      ROS_INFO_ONCE("Connection established with Slice Data UDP Port!");
+      previous_state_ = state_probe;
+      current_state_ = state_init;
+      break;
+    case state_done:
+      ROS_INFO_ONCE("Slice Data UDP packages arriving...");
+      flash_->processSliceData(data);
+      break;
+  }
+}
+
+void CameraCommander::updateIngestDiagnostics(diagnostic_updater::DiagnosticStatusWrapper& stat)
+{
+  stat.summary(diagnostic_msgs::DiagnosticStatus::OK, "OK");
+  for (const auto& receiver : udp_receivers_)
+  {
+    std::string port = "p" + std::to_string(receiver->getPort());
+    const hfl::PacketQueue& queue = receiver->getQueue();
+    stat.add(port + " received", receiver->getReceivedCount());
+    stat.add(port + " dropped", receiver->getDroppedCount());
+    stat.add(port + " queue depth", queue.depth());
+    stat.add(port + " max queue depth", queue.getMaxDepth());
+    stat.add(port + " queue overflows", queue.getOverflowCount());
+    if (queue.getOverflowCount() > 0)
+    {
+      stat.summary(diagnostic_msgs::DiagnosticStatus::WARN, "Receive queue overflow");
+    }
+  }
+  if (recorder_)
+  {
+    stat.add("recorded packets", recorder_->getRecordedCount());
+    stat.add("recorder dropped packets", recorder_->getDroppedCount());
+    stat.add("recorded bytes", recorder_->getWrittenBytes());
+    if (recorder_->getDroppedCount() > 0)
     {
-      case state_probe:
-        ROS_INFO_ONCE("Connection established with Slice Data UDP Port!");
-        previous_state_ = state_probe;
-        current_state_ = state_init;
-        break;
-      case state_done:
-        ROS_INFO_ONCE("Slice Data UDP packages arriving...");
-        flash_->processSliceData(udp_packet.data);
-        break;
+      stat.summary(diagnostic_msgs::DiagnosticStatus::WARN, "Recorder falling behind");
     }
   }
 }
@@ -503,6 +663,8 @@ void CameraCommander::dynamicPametersCallback(hfl_driver::HFLConfig& config, uin
     // camera is active
     if (flash_->setGlobalRangeOffset(config.global_range_offset))
       ROS_INFO("%s/global_range_offset: %f", namespace_.c_str(), config.global_range_offset);
+    if (flash_->setTimeOffset(config.time_offset))
+      ROS_INFO("%s/time_offset: %f", namespace_.c_str(), config.time_offset);
     if (flash_->setExtrinsicTranslatationX(config.x))
       ROS_INFO("%s/Translation x: %f", namespace_.c_str(), config.x);
     if (flash_->setExtrinsicTranslatationX(config.y))
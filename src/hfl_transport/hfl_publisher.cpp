@@ -0,0 +1,80 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// @file hfl_publisher.cpp
+///
+/// @brief This file implements the lossless hfl image transport publisher.
+///
+#include "hfl_transport/hfl_publisher.h"
+
+#include <depth_codec.h>
+
+#include <pluginlib/class_list_macros.h>
+#include <sensor_msgs/image_encodings.h>
+
+#include <string>
+
+#include "ros/ros.h"
+
+namespace hfl
+{
+void HFLPublisher::publish(const sensor_msgs::Image& message, const PublishFn& publish_fn) const
+{
+  namespace enc = sensor_msgs::image_encodings;
+  bool ranges = message.encoding == enc::TYPE_32FC1;
+  bool words = message.encoding == enc::TYPE_16UC1 || message.encoding == enc::MONO16;
+  size_t element_size = ranges ? sizeof(float) : sizeof(uint16_t);
+  if (!(ranges || words) || message.is_bigendian || message.step != message.width * element_size ||
+      message.data.size() < size_t(message.step) * message.height)
+  {
+    ROS_ERROR_THROTTLE(1.0, "hfl transport only compresses packed 32FC1 and 16 bit images, not %s",
+                       message.encoding.c_str());
+    return;
+  }
+
+  sensor_msgs::CompressedImage compressed;
+  compressed.header = message.header;
+  compressed.format = message.encoding + HFL_TRANSPORT_FORMAT;
+  if (ranges)
+  {
+    DepthCodec::encode(reinterpret_cast<const float*>(message.data.data()), message.height, message.width,
+                       compressed.data);
+  }
+  else
+  {
+    DepthCodec::encode(reinterpret_cast<const uint16_t*>(message.data.data()), message.height, message.width,
+                       compressed.data);
+  }
+  publish_fn(compressed);
+}
+}  // namespace hfl
+
+PLUGINLIB_EXPORT_CLASS(hfl::HFLPublisher, image_transport::PublisherPlugin)
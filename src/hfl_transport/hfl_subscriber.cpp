@@ -0,0 +1,77 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+///
+/// @file hfl_subscriber.cpp
+///
+/// @brief This file implements the lossless hfl image transport subscriber.
+///
+#include "hfl_transport/hfl_subscriber.h"
+
+#include <depth_codec.h>
+
+#include <pluginlib/class_list_macros.h>
+#include <sensor_msgs/image_encodings.h>
+
+#include <string>
+
+#include "ros/ros.h"
+
+namespace hfl
+{
+void HFLSubscriber::internalCallback(const sensor_msgs::CompressedImageConstPtr& message, const Callback& user_cb)
+{
+  // Decoded straight into the image handed to the user
+  sensor_msgs::ImagePtr image(new sensor_msgs::Image());
+  depth_codec_format format;
+  uint32_t rows, columns;
+  if (!DepthCodec::decode(message->data.data(), message->data.size(), format, rows, columns, image->data))
+  {
+    ROS_ERROR_THROTTLE(1.0, "Malformed hfl compressed image (%zu bytes)", message->data.size());
+    return;
+  }
+
+  // The encoding the image was published with leads the format
+  image->header = message->header;
+  image->height = rows;
+  image->width = columns;
+  image->encoding = message->format.substr(0, message->format.find(';'));
+  if (image->encoding.empty())
+  {
+    image->encoding = format == depth_codec_range ? sensor_msgs::image_encodings::TYPE_32FC1 :
+                                                    sensor_msgs::image_encodings::TYPE_16UC1;
+  }
+  image->is_bigendian = false;
+  image->step = columns * (format == depth_codec_range ? sizeof(float) : sizeof(uint16_t));
+  user_cb(image);
+}
+}  // namespace hfl
+
+PLUGINLIB_EXPORT_CLASS(hfl::HFLSubscriber, image_transport::SubscriberPlugin)
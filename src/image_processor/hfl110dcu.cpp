@@ -35,6 +35,8 @@
 ///
 #include "image_processor/hfl110dcu.h"
 #include <pluginlib/class_list_macros.h>
+#include <algorithm>
+#include <cstring>
 #include <string>
 #include <vector>
 #include <cmath>
@@ -49,14 +51,47 @@
 
 namespace hfl
 {
+namespace
+{
+/// Image encodings of the frame planes, indexed by frame_plane
+const std::string PLANE_ENCODINGS[plane_count] = {
+  sensor_msgs::image_encodings::TYPE_32FC1, sensor_msgs::image_encodings::TYPE_32FC1,
+  sensor_msgs::image_encodings::TYPE_16UC1, sensor_msgs::image_encodings::TYPE_16UC1,
+  sensor_msgs::image_encodings::TYPE_8UC1,  sensor_msgs::image_encodings::TYPE_8UC1,
+  sensor_msgs::image_encodings::TYPE_8UC1,  sensor_msgs::image_encodings::TYPE_8UC1,
+  sensor_msgs::image_encodings::TYPE_8UC1,  sensor_msgs::image_encodings::TYPE_8UC1
+};
+}  // namespace
+
 HFL110DCU::HFL110DCU(std::string model, std::string version,
                      std::string frame_id, ros::NodeHandle& node_handler)
   : node_handler_(node_handler)
+  , projector_(FRAME_ROWS, FRAME_COLUMNS)
+  , row_valid_pool_(MESSAGE_POOL_FRAMES, [](sensor_msgs::Image& image)
+                    {
+                      image.height = FRAME_ROWS;
+                      image.width = 1;
+                      image.encoding = sensor_msgs::image_encodings::MONO8;
+                      image.step = 1;
+                      image.data.resize(FRAME_ROWS);
+                    })
+  , cloud_pool_(REASSEMBLY_SLOTS + MESSAGE_POOL_FRAMES, &HFL110DCU::initCloud)
+  , packed_layout_(FRAME_ROWS, FRAME_COLUMNS)
 {
   // Set model and version
   model_ = model;
   version_ = version;
 
+  // Resolve the packet decoders of this firmware once
+  if (!getDecoders().find(model_, version_, decoders_))
+  {
+    ROS_ERROR("No decoder for %s version %s, packets are ignored", model_.c_str(), version_.c_str());
+    decoders_.frame = &HFL110DCU::ignorePacket;
+    decoders_.object = &HFL110DCU::ignorePacket;
+    decoders_.telemetry = &HFL110DCU::ignorePacket;
+    decoders_.slice = &HFL110DCU::ignorePacket;
+  }
+
   // Initialize header messages
   frame_header_message_.reset(new std_msgs::Header());
   pdm_header_message_.reset(new std_msgs::Header());
@@ -78,6 +113,7 @@ HFL110DCU::HFL110DCU(std::string model, std::string version,
   ros::NodeHandle sat2_nh(flag_nh, "saturated2");
   ros::NodeHandle si_nh(flag_nh, "si");
   ros::NodeHandle si2_nh(flag_nh, "si2");
+  ros::NodeHandle row_valid_nh(flag_nh, "row_valid");
 
   image_transport::ImageTransport it_depth(image_depth_nh);
   image_transport::ImageTransport it_depth2(image_depth2_nh);
@@ -90,21 +126,30 @@ HFL110DCU::HFL110DCU(std::string model, std::string version,
   image_transport::ImageTransport it_sat2(sat2_nh);
   image_transport::ImageTransport it_si(si_nh);
   image_transport::ImageTransport it_si2(si2_nh);
-
-  // Initialize publishers
-  pub_depth_ = it_depth.advertiseCamera("image_raw", 100);
-  pub_intensity_ = it_intensity_16b.advertiseCamera("image_raw", 100);
-  pub_depth2_ = it_depth2.advertiseCamera("image_raw", 100);
-  pub_intensity2_ = it_intensity2_16b.advertiseCamera("image_raw", 100);
-  pub_ct_ = it_ct.advertiseCamera("image_raw", 100);
-  pub_ct2_ = it_ct2.advertiseCamera("image_raw", 100);
-  pub_sat_ = it_sat.advertiseCamera("image_raw", 100);
-  pub_sat2_ = it_sat2.advertiseCamera("image_raw", 100);
-  pub_si_ = it_si.advertiseCamera("image_raw", 100);
-  pub_si2_ = it_si2.advertiseCamera("image_raw", 100);
-  pub_objects_ = objects_nh.advertise<visualization_msgs::MarkerArray>("objects", 100);
-  pub_points_ = node_handler_.advertise<sensor_msgs::PointCloud2>("points", 1000);
+  image_transport::ImageTransport it_row_valid(row_valid_nh);
+
+  // Build everything until all publishers exist
+  outputs_ = output_all;
+  lazy_outputs_ = false;
+
+  // Initialize publishers, outputs are reevaluated when subscribers come and go
+  image_transport::SubscriberStatusCallback image_status =
+    [this](const image_transport::SingleSubscriberPublisher&) { updateOutputs(); };
+  ros::SubscriberStatusCallback status = [this](const ros::SingleSubscriberPublisher&) { updateOutputs(); };
+  pub_depth_ = it_depth.advertiseCamera("image_raw", 100, image_status, image_status, status, status);
+  pub_intensity_ = it_intensity_16b.advertiseCamera("image_raw", 100, image_status, image_status, status, status);
+  pub_depth2_ = it_depth2.advertiseCamera("image_raw", 100, image_status, image_status, status, status);
+  pub_intensity2_ = it_intensity2_16b.advertiseCamera("image_raw", 100, image_status, image_status, status, status);
+  pub_ct_ = it_ct.advertiseCamera("image_raw", 100, image_status, image_status, status, status);
+  pub_ct2_ = it_ct2.advertiseCamera("image_raw", 100, image_status, image_status, status, status);
+  pub_sat_ = it_sat.advertiseCamera("image_raw", 100, image_status, image_status, status, status);
+  pub_sat2_ = it_sat2.advertiseCamera("image_raw", 100, image_status, image_status, status, status);
+  pub_si_ = it_si.advertiseCamera("image_raw", 100, image_status, image_status, status, status);
+  pub_si2_ = it_si2.advertiseCamera("image_raw", 100, image_status, image_status, status, status);
+  pub_objects_ = objects_nh.advertise<visualization_msgs::MarkerArray>("objects", 100, status, status);
+  pub_points_ = node_handler_.advertise<sensor_msgs::PointCloud2>("points", 1000, status, status);
   pub_slices_ = node_handler_.advertise<std_msgs::UInt16MultiArray>("slices", 1000);
+  pub_calibration_ = node_handler_.advertise<sensor_msgs::CameraInfo>("calibration_changed", 1, true);
 
   std::string default_calib_file = "~/.ros/camera_info/default.yaml";
 
@@ -120,370 +165,727 @@ HFL110DCU::HFL110DCU(std::string model, std::string version,
   // Initialize Message Headers
   frame_header_message_->frame_id = frame_id;
   frame_header_message_->seq = -1;
-  pdm_header_message_ = frame_header_message_;
-  tele_header_message_ = frame_header_message_;
-  slice_header_message_ = frame_header_message_;
+  // Separate copies, each port may be processed on its own thread
+  *pdm_header_message_ = *frame_header_message_;
+  *tele_header_message_ = *frame_header_message_;
+  *slice_header_message_ = *frame_header_message_;
   object_header_message_->frame_id = "map";  // TODO(flynneva): make this a ROS parameter
   object_header_message_->seq = -1;
   tf_header_message_->frame_id = "map";
   tf_header_message_->seq = 0;
   global_tf_.child_frame_id = frame_id;
+
+  // Frames kept open at once, rows of each may arrive in any order
+  int frame_slots;
+  double frame_timeout;
+  node_handler_.param("frame_slots", frame_slots, int(REASSEMBLY_SLOTS));
+  node_handler_.param("frame_timeout", frame_timeout, REASSEMBLY_TIMEOUT);
+  if (frame_slots < int(REASSEMBLY_SLOTS))
+  {
+    ROS_WARN("frame_slots must be at least %zu, using %zu", REASSEMBLY_SLOTS, REASSEMBLY_SLOTS);
+    frame_slots = REASSEMBLY_SLOTS;
+  }
+  reassembler_.reset(new FrameReassembler(FRAME_ROWS, frame_slots, frame_timeout));
+
+  // Completed frames are published on their own thread, a slow subscriber
+  // must not hold up decoding. A full queue drops the oldest or newest frame
+  int publish_queue;
+  std::string publish_overflow;
+  node_handler_.param("publish_queue", publish_queue, PUBLISH_QUEUE_FRAMES);
+  node_handler_.param<std::string>("publish_overflow", publish_overflow, "drop_oldest");
+  if (publish_overflow != "drop_oldest" && publish_overflow != "drop_newest")
+  {
+    ROS_WARN("publish_overflow must be drop_oldest or drop_newest, using drop_oldest");
+    publish_overflow = "drop_oldest";
+  }
+  if (publish_queue > 0)
+  {
+    publish_queue_.reset(new BoundedQueue<FramePublication>(
+      publish_queue, publish_overflow == "drop_newest" ? overflow_drop_newest : overflow_drop_oldest));
+  }
+  publish_latency_total_ = 0;
+  publish_count_ = 0;
+  publish_latency_max_ = 0;
+
+  // Images are sized once per plane, slots and the publisher queue hold one
+  // set per frame
+  for (int plane = 0; plane < plane_count; plane += 1)
+  {
+    image_pools_.push_back(std::make_shared<MessagePool<sensor_msgs::Image>>(
+      frame_slots + std::max(publish_queue, 0) + MESSAGE_POOL_FRAMES, [plane](sensor_msgs::Image& image)
+      {
+        image.height = FRAME_ROWS;
+        image.width = FRAME_COLUMNS;
+        image.encoding = PLANE_ENCODINGS[plane];
+        image.step = FRAME_COLUMNS * FrameBuffer::getElementSize(frame_plane(plane));
+        image.data.resize(image.step * image.height);
+      }));
+  }
+  camera_info_pool_size_ = std::max(publish_queue, 0) + MESSAGE_POOL_FRAMES;
+  updateCameraInfo(camera_info_manager_->getCameraInfo());
+  frame_slots_.resize(frame_slots);
+  for (FrameSlot& slot : frame_slots_)
+  {
+    initFrameSlot(slot);
+  }
+  slot_ = &frame_slots_[0];
+  frame_stamp_ = 0;
+  time_offset_ = 0.0;
+
+  // Stamp frames with the sensor acquisition time mapped to host time,
+  // off by default until the sensor clock tick is confirmed on hardware
+  double sensor_clock_tick;
+  node_handler_.param("clock_sync", clock_sync_enabled_, false);
+  node_handler_.param("sensor_clock_tick", sensor_clock_tick, CLOCK_SYNC_TICK);
+  clock_sync_ = ClockSync(sensor_clock_tick);
+  ROS_INFO("Row decoder kernel: %s", RowDecoder::getIsaName(row_decoder_.getIsa()));
+
+  // Publish incomplete frames at their deadline, missing rows set to NaN
+  node_handler_.param("publish_partial_frames", publish_partial_frames_, false);
+  if (publish_partial_frames_)
+  {
+    pub_row_valid_ = it_row_valid.advertiseCamera("image_raw", 100);
+  }
+
+  // All channels of a frame in one message instead of ten images and camera infos
+  bool publish_packed_frame;
+  node_handler_.param("publish_packed_frame", publish_packed_frame, false);
+  if (publish_packed_frame)
+  {
+    packed_pool_.reset(new MessagePool<hfl_driver::PackedFrame>(
+      frame_slots + std::max(publish_queue, 0) + MESSAGE_POOL_FRAMES,
+      [this](hfl_driver::PackedFrame& packed) { initPackedFrame(packed); }));
+    pub_packed_ = node_handler_.advertise<hfl_driver::PackedFrame>("packed_frame", 100, status, status);
+    outputs_ |= output_packed;
+  }
+
+  // Skip decoding, projection and markers nobody subscribes to
+  bool lazy_outputs;
+  node_handler_.param("lazy_outputs", lazy_outputs, true);
+  lazy_outputs_ = lazy_outputs;
+  updateOutputs();
+
+  if (publish_queue_)
+  {
+    publish_thread_ = std::thread(&HFL110DCU::publishLoop, this);
+  }
 }
 
-bool HFL110DCU::parseFrame(int start_byte, const std::vector<uint8_t>& packet)
+HFL110DCU::~HFL110DCU()
 {
-  int byte_offset = 0;
-
-  float range_1, range_2, temp_range = 0;
-  uint16_t intensity_1, intensity_2 = 0;
-  uint8_t classification, ch = 0;
+  if (publish_queue_)
+  {
+    publish_queue_->close();
+  }
+  if (publish_thread_.joinable())
+  {
+    publish_thread_.join();
+  }
+}
 
-  // Build up range and intensity images
-  for (col_ = 0; col_ < FRAME_COLUMNS; col_ += 1)
+const DecoderRegistry<HFL110DCUDecoders>& HFL110DCU::getDecoders()
+{
+  // Built once, also when cameras are created concurrently
+  static const DecoderRegistry<HFL110DCUDecoders> registry = []()
   {
-    byte_offset = start_byte + (col_ * 4);
-    // Populate range images
-    range_1 = (global_offset_ + float(
-      big_to_native(*reinterpret_cast<const uint16_t*>(&packet[byte_offset])))) / 256.0;
-    range_2 = (global_offset_ + float(
-      big_to_native(*reinterpret_cast<const uint16_t*>(&packet[byte_offset + 2])))) / 256.0;
+    DecoderRegistry<HFL110DCUDecoders> decoders;
+    HFL110DCUDecoders v1;
+    v1.frame = &HFL110DCU::processFrameDataV1;
+    v1.object = &HFL110DCU::processObjectDataV1;
+    v1.telemetry = &HFL110DCU::processTelemetryDataV1;
+    v1.slice = &HFL110DCU::processSliceDataV1;
+    decoders.add("hfl110dcu", "v1", v1);
+    // Register new firmware versions here
+    return decoders;
+  }();
+  return registry;
+}
 
-    // Byte offset for intensity
-    // Intensity Data follows Full Row of Depth Data (128 * 2 returns * 2bytes each)
-    byte_offset = start_byte + 512 + (col_ * 4);
+bool HFL110DCU::processFrameData(PacketView frame_data)
+{
+  bool processed = (this->*decoders_.frame)(frame_data);
+  updateFrameDiagnostics();
+  return processed;
+}
 
-    // Populate intensity images
-    intensity_1 = uint16_t(
-      big_to_native(*reinterpret_cast<const uint16_t*>(&packet[byte_offset])));
-    intensity_2 = uint16_t(
-      big_to_native(*reinterpret_cast<const uint16_t*>(&packet[byte_offset + 2])));
+bool HFL110DCU::processObjectData(PacketView object_data)
+{
+  return (this->*decoders_.object)(object_data);
+}
+
+bool HFL110DCU::processTelemetryData(PacketView tele_data)
+{
+  return (this->*decoders_.telemetry)(tele_data);
+}
 
-    // If range is larger than 49m, set it to NAN
-    if (range_1 > 49.0)
-      range_1 = NAN;
+bool HFL110DCU::processSliceData(PacketView slice_data)
+{
+  return (this->*decoders_.slice)(slice_data);
+}
 
-    if (range_2 > 49.0)
-      range_2 = NAN;
+void HFL110DCU::updateFrameDiagnostics()
+{
+  FrameDiagnostics& diagnostics = frame_diagnostics_;
+  diagnostics.frames_completed.store(reassembler_->getCompletedCount(), std::memory_order_relaxed);
+  diagnostics.frames_evicted.store(reassembler_->getEvictedCount(), std::memory_order_relaxed);
+  diagnostics.late_rows.store(reassembler_->getLateCount(), std::memory_order_relaxed);
+  diagnostics.duplicate_rows.store(reassembler_->getDuplicateCount(), std::memory_order_relaxed);
+  diagnostics.clock_offset.store(clock_sync_.getOffset(), std::memory_order_relaxed);
+  diagnostics.clock_drift.store(clock_sync_.getDrift(), std::memory_order_relaxed);
+  diagnostics.clock_resets.store(clock_sync_.getResetCount(), std::memory_order_relaxed);
+  diagnostics.calibration_epoch.store(calibration_monitor_.getEpoch(), std::memory_order_relaxed);
+  diagnostics.calibration_hash.store(calibration_monitor_.getHash(), std::memory_order_relaxed);
+}
 
-    p_image_depth_->image.at<float>(cv::Point(col_, row_)) = range_1;
-    p_image_depth2_->image.at<float>(cv::Point(col_, row_)) = range_2;
+bool HFL110DCU::ignorePacket(PacketView)
+{
+  return false;
+}
 
-    p_image_intensity_->image.at<uint16_t>(cv::Point(col_, row_)) = intensity_1;
-    p_image_intensity2_->image.at<uint16_t>(cv::Point(col_, row_)) = intensity_2;
+namespace
+{
+/// Returns the range and intensity planes of a frame buffer row
+DecodedRow rangeRow(FrameBuffer& buffer, int row)
+{
+  DecodedRow planes;
+  planes.range_1 = buffer.getRow<float>(plane_depth, row);
+  planes.range_2 = buffer.getRow<float>(plane_depth2, row);
+  planes.intensity_1 = buffer.getRow<uint16_t>(plane_intensity, row);
+  planes.intensity_2 = buffer.getRow<uint16_t>(plane_intensity2, row);
+  return planes;
+}
 
-    // Byte offset for classification flags
-    byte_offset = start_byte + 1152 + col_;
+/// Returns the flag planes of a frame buffer row
+DecodedFlags flagRow(FrameBuffer& buffer, int row)
+{
+  DecodedFlags planes;
+  planes.crosstalk = buffer.getRow<uint8_t>(plane_crosstalk, row);
+  planes.saturated = buffer.getRow<uint8_t>(plane_saturated, row);
+  planes.superimposed = buffer.getRow<uint8_t>(plane_superimposed, row);
+  planes.crosstalk_2 = buffer.getRow<uint8_t>(plane_crosstalk2, row);
+  planes.saturated_2 = buffer.getRow<uint8_t>(plane_saturated2, row);
+  planes.superimposed_2 = buffer.getRow<uint8_t>(plane_superimposed2, row);
+  return planes;
+}
+}  // namespace
 
-    classification = big_to_native(*reinterpret_cast<const uint8_t*>(&packet[byte_offset]));
-    
-    p_image_crosstalk_->image.at<uint8_t>(cv::Point(col_, row_)) = ((classification >> 0) & 1) * 255;
-    p_image_saturated_->image.at<uint8_t>(cv::Point(col_, row_)) = ((classification >> 1) & 1) * 255;
-    p_image_superimposed_->image.at<uint8_t>(cv::Point(col_, row_)) = ((classification >> 3) & 1) * 255;
-    
-    p_image_crosstalk2_->image.at<uint8_t>(cv::Point(col_, row_)) = ((classification >> 4) & 1) * 255;
-    p_image_saturated2_->image.at<uint8_t>(cv::Point(col_, row_)) = ((classification >> 5) & 1) * 255;
-    p_image_superimposed2_->image.at<uint8_t>(cv::Point(col_, row_)) = ((classification >> 7) & 1) * 255;
+bool HFL110DCU::parseFrame(int start_byte, PacketView packet)
+{
+  FrameBuffer& buffer = *slot_->buffer;
 
-    if (ch < 3) {
-      ch += 1;
-    } else {
-      ch = 0;
+  // Build up range and intensity images, one row at a time
+  if (slot_->outputs & output_ranges)
+  {
+    RangeTable::Reader range(range_table_);
+    row_decoder_.decode(&packet[start_byte], range.get(), rangeRow(buffer, row_));
+  }
+
+  // The packed frame takes decoded rows from the images, or decodes on its own
+  if (slot_->outputs & output_packed)
+  {
+    uint8_t* packed = slot_->packed->data.data();
+    if (slot_->outputs & output_ranges)
+    {
+      packed_layout_.copyRanges(packed, row_, rangeRow(buffer, row_));
+    }
+    else
+    {
+      RangeTable::Reader range(range_table_);
+      row_decoder_.decode(&packet[start_byte], range.get(), packed_layout_.getRangeRow(packed, row_));
+    }
+    packed_layout_.copyFlags(packed, row_, &packet[start_byte + ROW_FLAG_OFFSET]);
+  }
+
+  // Expand classification flags into one image per flag
+  if (slot_->outputs & output_flags)
+  {
+    row_decoder_.unpackFlags(&packet[start_byte + ROW_FLAG_OFFSET], flagRow(buffer, row_));
+  }
+
+  return true;
+}
+
+void HFL110DCU::projectRow(FrameSlot& slot, int row)
+{
+  FrameBuffer& buffer = *slot.buffer;
+  projector_.projectRow(row, rangeRow(buffer, row), flagRow(buffer, row),
+                        &slot.cloud->data[row * slot.cloud->row_step]);
+}
+
+ros::Time HFL110DCU::receiveStamp(PacketView packet)
+{
+  // Packets from udp_com carry no kernel timestamp
+  if (packet.getReceiveTime() == 0)
+  {
+    return ros::Time::now();
+  }
+  return ros::Time().fromNSec(packet.getReceiveTime());
+}
+
+bool HFL110DCU::processFrameDataV1(PacketView frame_data)
+{
+  if (!FrameViewV1::fits<FrameLayoutV1::Packet>(frame_data))
+  {
+    ROS_WARN_THROTTLE(1.0, "Frame packet too short: %zu bytes", frame_data.size());
+    return false;
+  }
+  FrameViewV1 frame(frame_data);
+
+  // identify packet by fragmentation offset
+  row_ = FRAME_ROWS - 1 - frame.get<FrameLayoutV1::RowNumber>();
+  uint32_t frame_num = frame.get<FrameLayoutV1::FrameNumber>();
+  uint64_t sensor_time = frame.get<FrameLayoutV1::Timestamp>();
+  ros::Time now = receiveStamp(frame_data);
+
+  // Evict frames which did not complete in time
+  FrameSlotInfo expired;
+  while (reassembler_->expire(now.toSec(), expired))
+  {
+    ROS_WARN_THROTTLE(1.0, "Frame %u incomplete (dropped packet?), rows received: 0x%08x",
+                      expired.frame_number, expired.row_mask);
+    if (publish_partial_frames_)
+    {
+      publishFrame(frame_slots_[expired.slot], expired.row_mask);
     }
   }
 
+  // Add row to its frame, rows may arrive in any order
+  StageTimer timer(profiler_.get());
+  RowInsertion insertion = reassembler_->insert(frame_num, row_, now.toSec());
+  if (insertion.evicted)
+  {
+    ROS_WARN_THROTTLE(1.0, "Frame %u incomplete (dropped packet?), rows received: 0x%08x",
+                      insertion.evicted_frame.frame_number, insertion.evicted_frame.row_mask);
+    // Publish before the slot is reset for the new frame
+    if (publish_partial_frames_)
+    {
+      publishFrame(frame_slots_[insertion.evicted_frame.slot], insertion.evicted_frame.row_mask);
+    }
+  }
+  if (insertion.status != row_accepted)
+  {
+    return false;
+  }
+  timer.lap(stage_reassembly);
+
+  // Every accepted row is a sample of the sensor clock against the host clock,
+  // malformed, duplicate and late rows are not
+  clock_sync_.addSample(sensor_time, now.toSec());
+
+  slot_ = &frame_slots_[insertion.slot];
+
+  // First packet of a frame, every row is overwritten or cleared before publishing
+  if (insertion.started)
+  {
+    // Frame is stamped with the arrival of its first row
+    slot_->stamp = now;
+    slot_->sensor_time = sensor_time;
+    updateCalibration(frame_data);
+    acquireMessages(*slot_);
+  }
+
+  // Parse image data
+  parseFrame(FrameLayoutV1::Pixels::offset, frame_data);
+  timer.lap(stage_row_decode);
+
+  // Project the row now, publishing the last row only sends the points
+  if (slot_->outputs & output_points)
+  {
+    projectRow(*slot_, row_);
+    timer.lap(stage_projection);
+  }
+
+  // All rows arrived, publish frame data
+  if (insertion.complete)
+  {
+    publishFrame(*slot_, reassembler_->getFullMask());
+  }
   return true;
 }
 
-bool HFL110DCU::processFrameData(const std::vector<uint8_t>& frame_data)
+void HFL110DCU::initFrameSlot(FrameSlot& slot)
+{
+  // Planes are bound to the frame's images while it is reassembled
+  slot.buffer.reset(new FrameBuffer(FRAME_ROWS, FRAME_COLUMNS, false));
+  slot.outputs = output_all;
+}
+
+void HFL110DCU::initCloud(sensor_msgs::PointCloud2& cloud)
+{
+  // Sized once, reused clouds keep their data buffer
+  cloud.height = FRAME_ROWS;
+  cloud.width = FRAME_COLUMNS * 2;
+  sensor_msgs::PointCloud2Modifier modifier(cloud);
+  modifier.setPointCloud2Fields(8,
+    "x", 1, sensor_msgs::PointField::FLOAT32,
+    "y", 1, sensor_msgs::PointField::FLOAT32,
+    "z", 1, sensor_msgs::PointField::FLOAT32,
+    "intensity", 1, sensor_msgs::PointField::FLOAT32,
+    "return", 1, sensor_msgs::PointField::UINT8,
+    "crosstalk", 1, sensor_msgs::PointField::UINT8,
+    "saturated", 1, sensor_msgs::PointField::UINT8,
+    "superimposed", 1, sensor_msgs::PointField::UINT8);
+  ROS_ASSERT(cloud.point_step == POINT_STEP && cloud.row_step == FRAME_COLUMNS * 2 * POINT_STEP);
+}
+
+void HFL110DCU::initPackedFrame(hfl_driver::PackedFrame& packed) const
+{
+  // Sized once, reused frames keep their data buffer
+  packed.height = FRAME_ROWS;
+  packed.width = FRAME_COLUMNS;
+  packed.is_bigendian = false;
+  packed.range_offset = packed_layout_.getOffset(packed_range);
+  packed.range2_offset = packed_layout_.getOffset(packed_range2);
+  packed.intensity_offset = packed_layout_.getOffset(packed_intensity);
+  packed.intensity2_offset = packed_layout_.getOffset(packed_intensity2);
+  packed.flags_offset = packed_layout_.getOffset(packed_flags);
+  packed.data.resize(packed_layout_.getSize());
+}
+
+void HFL110DCU::updateOutputs()
 {
-  if (version_ == "v1")
+  if (!lazy_outputs_)
   {
-    int size = frame_data.size();
+    return;
+  }
+  uint32_t outputs = 0;
+  if (pub_depth_.getNumSubscribers() > 0 || pub_intensity_.getNumSubscribers() > 0 ||
+      pub_depth2_.getNumSubscribers() > 0 || pub_intensity2_.getNumSubscribers() > 0)
+  {
+    outputs |= output_ranges;
+  }
+  if (pub_ct_.getNumSubscribers() > 0 || pub_ct2_.getNumSubscribers() > 0 ||
+      pub_sat_.getNumSubscribers() > 0 || pub_sat2_.getNumSubscribers() > 0 ||
+      pub_si_.getNumSubscribers() > 0 || pub_si2_.getNumSubscribers() > 0)
+  {
+    outputs |= output_flags;
+  }
+  // Points carry ranges, intensities and flags
+  if (pub_points_.getNumSubscribers() > 0)
+  {
+    outputs |= output_points | output_ranges | output_flags;
+  }
+  if (pub_objects_.getNumSubscribers() > 0)
+  {
+    outputs |= output_objects;
+  }
+  if (pub_packed_.getNumSubscribers() > 0)
+  {
+    outputs |= output_packed;
+  }
+  if (outputs != outputs_.exchange(outputs))
+  {
+    ROS_DEBUG("Outputs with subscribers: 0x%x", outputs);
+  }
+}
 
-    // identify packet by fragmentation offset
-    row_ = FRAME_ROWS - 1 - big_to_native(*reinterpret_cast<const uint32_t*>(&frame_data[16]));
-    int frame_num = big_to_native(*reinterpret_cast<const uint32_t*>(&frame_data[12]));
+void HFL110DCU::acquireMessages(FrameSlot& slot)
+{
+  // Subscribers joining mid frame get the next frame, this one lacks earlier rows
+  slot.outputs = outputs_;
 
-    // Check packet offset continuity
-    if ( row_ != expected_packet_)
+  // Every row is decoded or cleared before publishing, stale data is fine
+  for (int plane = 0; plane < plane_count; plane += 1)
+  {
+    slot.images[plane] = image_pools_[plane]->acquire<sensor_msgs::ImagePtr>();
+    slot.buffer->bindPlane(frame_plane(plane), slot.images[plane]->data.data());
+  }
+  slot.cloud = cloud_pool_.acquire<sensor_msgs::PointCloud2Ptr>();
+  if (slot.outputs & output_packed)
+  {
+    slot.packed = packed_pool_->acquire<hfl_driver::PackedFramePtr>();
+    slot.packed->calibration_hash = calibration_monitor_.getHash();
+    slot.packed->calibration_epoch = calibration_monitor_.getEpoch();
+  }
+}
+
+void HFL110DCU::releaseMessages(FrameSlot& slot, FramePublication& publication)
+{
+  // Subscribers may hold the messages once published, stop writing into them
+  for (int plane = 0; plane < plane_count; plane += 1)
+  {
+    slot.buffer->bindPlane(frame_plane(plane), nullptr);
+    publication.images[plane] = std::move(slot.images[plane]);
+  }
+  publication.cloud = std::move(slot.cloud);
+  publication.packed = std::move(slot.packed);
+  publication.outputs = slot.outputs;
+}
+
+void HFL110DCU::updateCalibration(PacketView frame_data)
+{
+  // Camera info, transform and rays only change with the calibration block
+  FrameViewV1 calibration(frame_data);
+  if (!calibration_monitor_.update(calibration.at<FrameLayoutV1::CalibrationParameters>(),
+                                   FrameLayoutV1::CalibrationParameters::size))
+  {
+    return;
+  }
+
+  // Get intrinsic and extrinsic calibration parameters
+  float fx = calibration.get<FrameLayoutV1::Fx>();
+  float fy = calibration.get<FrameLayoutV1::Fy>();
+  float ux = calibration.get<FrameLayoutV1::Ux>();
+  float uy = calibration.get<FrameLayoutV1::Uy>();
+  float r1 = calibration.get<FrameLayoutV1::R1>();
+  float r2 = calibration.get<FrameLayoutV1::R2>();
+  float t1 = calibration.get<FrameLayoutV1::T1>();
+  float t2 = calibration.get<FrameLayoutV1::T2>();
+  float r4 = calibration.get<FrameLayoutV1::R4>();
+  ROS_INFO("Calibration %u received from DCU:", calibration_monitor_.getEpoch());
+  ROS_INFO("    fx: %.4f fy: %.4f ux: %.4f uy: %.4f", fx, fy, ux, uy);
+  ROS_INFO("    r1: %.4f r2: %.4f t1: %.4f t2: %.4f r4: %.4f", r1, r2, t1, t2, r4);
+
+  float intrinsic_yaw = calibration.get<FrameLayoutV1::IntrinsicYaw>();
+  float intrinsic_pitch = calibration.get<FrameLayoutV1::IntrinsicPitch>();
+  float extrinsic_yaw = calibration.get<FrameLayoutV1::ExtrinsicYaw>();
+  float extrinsic_pitch = calibration.get<FrameLayoutV1::ExtrinsicPitch>();
+  float extrinsic_roll = calibration.get<FrameLayoutV1::ExtrinsicRoll>();
+  float extrinsic_z = calibration.get<FrameLayoutV1::ExtrinsicZ>();
+  float extrinsic_y = calibration.get<FrameLayoutV1::ExtrinsicY>();
+  float extrinsic_x = calibration.get<FrameLayoutV1::ExtrinsicX>();
+
+  // TODO: implement check if new extrinsics of dynamic reconfigure are available
+
+  ROS_INFO("    x: %f y: %f z: %f", extrinsic_x, extrinsic_y, extrinsic_z);
+  ROS_INFO("    r: %f p: %f y: %f", extrinsic_roll, extrinsic_pitch, extrinsic_yaw);
+
+  // set extrinsics to global tf
+  tf2::Quaternion q_orig, q_rot, q_final;
+
+  // Output extrinsics are in AUTOSAR format, rotate to match ROS standard
+  double r=-1.5707, p=0.0, y=-1.5707;
+  q_rot.setRPY(r, p, y);
+
+  global_tf_.transform.translation.x = extrinsic_x;
+  global_tf_.transform.translation.y = extrinsic_y;
+  global_tf_.transform.translation.z = extrinsic_z;
+  q_orig.setRPY(extrinsic_roll, extrinsic_pitch, extrinsic_yaw);
+  q_final = q_orig * q_rot;  // Calculate actual orientation
+  q_final.normalize();
+  global_tf_.transform.rotation = tf2::toMsg(q_final);
+
+  // check camera info manager
+  if (camera_info_manager_ != NULL)
+  {
+    auto ci = camera_info_manager_->getCameraInfo();
+
+    if (ci.K[0] != fx || ci.K[2] != ux || ci.K[4] != fy || ci.K[5] != uy || ci.D.size() != 8 ||
+        ci.D[0] != r1 || ci.D[1] != r2 || ci.D[2] != t1 || ci.D[3] != t2 || ci.D[5] != r4)
     {
-      ROS_ERROR("Unexpected packet (dropped packet?) expecting: %i, received:  %i",
-              expected_packet_, row_);
-      expected_packet_ = FRAME_ROWS - 1;
-      return false;
+      ROS_WARN("Initialized intrinsics do not match those received from sensor");
+      ROS_WARN("Setting intrinsics to values received from sensor");
+      // set default values
+      ci.distortion_model = "rational_polynomial";
+      ci.height = FRAME_ROWS;
+      ci.width = FRAME_COLUMNS;
+      ci.D.resize(8);
+      ci.D[0] = r1;
+      ci.D[1] = r2;
+      ci.D[2] = t1;
+      ci.D[3] = t2;
+      ci.D[4] = 0;
+      ci.D[5] = r4;
+      ci.D[6] = 0;
+      ci.D[7] = 0;
+
+      ci.K[0] = fx;
+      ci.K[2] = ux;
+      ci.K[4] = fy;
+      ci.K[5] = uy;
+      ci.K[8] = 1;
+
+      ci.P[0] = fx;
+      ci.P[2] = ux;
+      ci.P[4] = fy;
+      ci.P[5] = uy;
+      ci.P[11] = 1;
+
+      camera_info_manager_->setCameraInfo(ci);
     }
+    updateCameraInfo(ci);
 
-    // First frame packet, reset frame data
-    if (row_ == (FRAME_ROWS - 1))
+    // Rays of every pixel
+    transform_ = initTransform(cv::Mat_<double>(3, 3, &ci.K[0]),
+                                   cv::Mat(ci.D), ci.width, ci.height, true);
+    for (int row = 0; row < FRAME_ROWS; row += 1)
     {
-      // Set header message
-      frame_header_message_->stamp = ros::Time::now();
-      object_header_message_->stamp = frame_header_message_->stamp;
-      tf_header_message_->stamp = frame_header_message_->stamp;
-
-      // Set Pointcloud message
-      pointcloud_.reset(new sensor_msgs::PointCloud2());
-      pointcloud_->header = *frame_header_message_;
-      pointcloud_->height = FRAME_ROWS;
-      pointcloud_->width = FRAME_COLUMNS * 2;
-
-      sensor_msgs::PointCloud2Modifier modifier(*pointcloud_);
-      modifier.setPointCloud2Fields(8,
-        "x", 1, sensor_msgs::PointField::FLOAT32,
-        "y", 1, sensor_msgs::PointField::FLOAT32,
-        "z", 1, sensor_msgs::PointField::FLOAT32,
-        "intensity", 1, sensor_msgs::PointField::FLOAT32,
-        "return", 1, sensor_msgs::PointField::UINT8,
-        "crosstalk", 1, sensor_msgs::PointField::UINT8,
-        "saturated", 1, sensor_msgs::PointField::UINT8,
-        "superimposed", 1, sensor_msgs::PointField::UINT8);
-
-      // Reset image pointers
-      p_image_depth_.reset(new cv_bridge::CvImage);
-      p_image_depth_->encoding = sensor_msgs::image_encodings::TYPE_32FC1;
-      p_image_depth_->image = cv::Mat(FRAME_ROWS, FRAME_COLUMNS, CV_32FC1);
-
-      p_image_intensity_.reset(new cv_bridge::CvImage);
-      p_image_intensity_->encoding = sensor_msgs::image_encodings::TYPE_16UC1;
-      p_image_intensity_->image = cv::Mat(FRAME_ROWS, FRAME_COLUMNS, CV_16UC1);
-
-      p_image_depth2_.reset(new cv_bridge::CvImage);
-      p_image_depth2_->encoding = sensor_msgs::image_encodings::TYPE_32FC1;
-      p_image_depth2_->image = cv::Mat(FRAME_ROWS, FRAME_COLUMNS, CV_32FC1);
-
-      p_image_intensity2_.reset(new cv_bridge::CvImage);
-      p_image_intensity2_->encoding = sensor_msgs::image_encodings::TYPE_16UC1;
-      p_image_intensity2_->image = cv::Mat(FRAME_ROWS, FRAME_COLUMNS, CV_16UC1);
-
-      p_image_crosstalk_.reset(new cv_bridge::CvImage);
-      p_image_crosstalk_->encoding = sensor_msgs::image_encodings::TYPE_8UC1;
-      p_image_crosstalk_->image = cv::Mat(FRAME_ROWS, FRAME_COLUMNS, CV_8UC1);
-      p_image_saturated_.reset(new cv_bridge::CvImage);
-      p_image_saturated_->encoding = sensor_msgs::image_encodings::TYPE_8UC1;
-      p_image_saturated_->image = cv::Mat(FRAME_ROWS, FRAME_COLUMNS, CV_8UC1);
-      p_image_superimposed_.reset(new cv_bridge::CvImage);
-      p_image_superimposed_->encoding = sensor_msgs::image_encodings::TYPE_8UC1;
-      p_image_superimposed_->image = cv::Mat(FRAME_ROWS, FRAME_COLUMNS, CV_8UC1);
-      
-      p_image_crosstalk2_.reset(new cv_bridge::CvImage);
-      p_image_crosstalk2_->encoding = sensor_msgs::image_encodings::TYPE_8UC1;
-      p_image_crosstalk2_->image = cv::Mat(FRAME_ROWS, FRAME_COLUMNS, CV_8UC1);
-      p_image_saturated2_.reset(new cv_bridge::CvImage);
-      p_image_saturated2_->encoding = sensor_msgs::image_encodings::TYPE_8UC1;
-      p_image_saturated2_->image = cv::Mat(FRAME_ROWS, FRAME_COLUMNS, CV_8UC1);
-      p_image_superimposed2_.reset(new cv_bridge::CvImage);
-      p_image_superimposed2_->encoding = sensor_msgs::image_encodings::TYPE_8UC1;
-      p_image_superimposed2_->image = cv::Mat(FRAME_ROWS, FRAME_COLUMNS, CV_8UC1);
-      
-      // Get intrinsic and extrinsic calibration parameters
-      // CameraIntrinsics * camera_intrinsics;
-      float fx = *reinterpret_cast<const float*>(&frame_data[20]);
-      ROS_INFO_ONCE("fx: %.4f", fx);
-      float fy = *reinterpret_cast<const float*>(&frame_data[24]);
-      ROS_INFO_ONCE("fy: %.4f", fy);
-      float ux = *reinterpret_cast<const float*>(&frame_data[28]);
-      ROS_INFO_ONCE("ux: %.4f", ux);
-      float uy = *reinterpret_cast<const float*>(&frame_data[32]);
-      ROS_INFO_ONCE("uy: %.4f", uy);
-      float r1 = *reinterpret_cast<const float*>(&frame_data[36]);
-      ROS_INFO_ONCE("r1: %.4f", r1);
-      float r2 = *reinterpret_cast<const float*>(&frame_data[40]);
-      ROS_INFO_ONCE("r2: %.4f", r2);
-      float t1 = *reinterpret_cast<const float*>(&frame_data[44]);
-      ROS_INFO_ONCE("t1: %.4f", t1);
-      float t2 = *reinterpret_cast<const float*>(&frame_data[48]);
-      ROS_INFO_ONCE("t2: %.4f", t2);
-      float r4 = *reinterpret_cast<const float*>(&frame_data[52]);
-      ROS_INFO_ONCE("r4: %.4f", r4);
-
-      float intrinsic_yaw = *reinterpret_cast<const float*>(&frame_data[56]);
-      float intrinsic_pitch = *reinterpret_cast<const float*>(&frame_data[60]);
-      float extrinsic_yaw = *reinterpret_cast<const float*>(&frame_data[64]);
-      float extrinsic_pitch = *reinterpret_cast<const float*>(&frame_data[68]);
-      float extrinsic_roll = *reinterpret_cast<const float*>(&frame_data[72]);
-      float extrinsic_z = *reinterpret_cast<const float*>(&frame_data[76]);
-      float extrinsic_y = *reinterpret_cast<const float*>(&frame_data[80]);
-      float extrinsic_x = *reinterpret_cast<const float*>(&frame_data[84]);
-
-      // TODO: implement check if new extrinsics of dynamic reconfigure are available
-
-      ROS_INFO_ONCE("Extrinsics received from DCU:");
-      ROS_INFO_ONCE("    x: %f", extrinsic_x);
-      ROS_INFO_ONCE("    y: %f", extrinsic_y);
-      ROS_INFO_ONCE("    z: %f", extrinsic_z);
-      ROS_INFO_ONCE("    r: %f", extrinsic_roll);
-      ROS_INFO_ONCE("    p: %f", extrinsic_pitch);
-      ROS_INFO_ONCE("    y: %f", extrinsic_yaw);
-
-      // set extrinsics to global tf
-      tf2::Quaternion q_orig, q_rot, q_final;
-
-      // Output extrinsics are in AUTOSAR format, rotate to match ROS standard
-      double r=-1.5707, p=0.0, y=-1.5707;
-      q_rot.setRPY(r, p, y);
-
-      global_tf_.transform.translation.x = extrinsic_x;
-      global_tf_.transform.translation.y = extrinsic_y;
-      global_tf_.transform.translation.z = extrinsic_z;
-      q_orig.setRPY(extrinsic_roll, extrinsic_pitch, extrinsic_yaw);
-      q_final = q_orig * q_rot;  // Calculate actual orientation
-      q_final.normalize();
-      global_tf_.transform.rotation = tf2::toMsg(q_final);
-
-      // check camera info manager
-      if (camera_info_manager_ != NULL)
+      for (int col = 0; col < FRAME_COLUMNS; col += 1)
       {
-        auto ci = camera_info_manager_->getCameraInfo();
-
-        if (ci.K[0] != fx)
-        {
-          ROS_WARN("Initialized intrinsics do not match those received from sensor");
-          ROS_WARN("Setting intrinsics to values received from sensor");
-          // set default values
-          ci.distortion_model = "rational_polynomial";
-          ci.height = FRAME_ROWS;
-          ci.width = FRAME_COLUMNS;
-          ci.D.resize(8);
-          ci.D[0] = r1;
-          ci.D[1] = r2;
-          ci.D[2] = t1;
-          ci.D[3] = t2;
-          ci.D[4] = 0;
-          ci.D[5] = r4;
-          ci.D[6] = 0;
-          ci.D[7] = 0;
-
-          ci.K[0] = fx;
-          ci.K[2] = ux;
-          ci.K[4] = fy;
-          ci.K[5] = uy;
-          ci.K[8] = 1;
-
-          ci.P[0] = fx;
-          ci.P[2] = ux;
-          ci.P[4] = fy;
-          ci.P[5] = uy;
-          ci.P[11] = 1;
-
-          camera_info_manager_->setCameraInfo(ci);
-
-          transform_ = initTransform(cv::Mat_<double>(3, 3, &ci.K[0]),
-                                         cv::Mat(ci.D), ci.width, ci.height, true);
-        }
+        const cv::Vec3f& ray = transform_.at<cv::Vec3f>(col, row);
+        projector_.setRay(row, col, ray(0), ray(1), ray(2));
       }
     }
 
-    // Parse image data
-    parseFrame(92, frame_data);
+    // Tell subscribers, latched so late subscribers see the current calibration
+    ci.header = *frame_header_message_;
+    ci.header.stamp = receiveStamp(frame_data);
+    ci.header.seq = calibration_monitor_.getEpoch();
+    pub_calibration_.publish(ci);
+  }
+}
+
+void HFL110DCU::updateCameraInfo(const sensor_msgs::CameraInfo& info)
+{
+  // Frames only restamp the header, D, K, R and P are copied once per message
+  sensor_msgs::CameraInfo calibration = info;
+  calibration.header = std_msgs::Header();
+  camera_info_pool_.reset(new MessagePool<sensor_msgs::CameraInfo>(
+    camera_info_pool_size_, [calibration](sensor_msgs::CameraInfo& camera_info) { camera_info = calibration; }));
+}
 
-    // Last frame packet, pulish frame data
-    if (row_ == 0)
+void HFL110DCU::fillMissingRows(FrameSlot& slot, uint32_t row_mask)
+{
+  for (int row = 0; row < FRAME_ROWS; row += 1)
+  {
+    if (!((row_mask >> row) & 1))
     {
-      // Get camera info
-      auto ci = camera_info_manager_->getCameraInfo();
-      sensor_msgs::CameraInfoPtr flash_cam_info(new sensor_msgs::CameraInfo(ci));
-
-      flash_cam_info->header = *frame_header_message_;
-
-      p_image_depth_->header = *frame_header_message_;
-      p_image_intensity_->header = *frame_header_message_;
-      pub_depth_.publish(p_image_depth_->toImageMsg(), flash_cam_info);
-      pub_intensity_.publish(p_image_intensity_->toImageMsg(), flash_cam_info);
-
-      p_image_depth2_->header = *frame_header_message_;
-      p_image_intensity2_->header = *frame_header_message_;
-      pub_depth2_.publish(p_image_depth2_->toImageMsg(), flash_cam_info);
-      pub_intensity2_.publish(p_image_intensity2_->toImageMsg(), flash_cam_info);
-
-      p_image_crosstalk_->header = *frame_header_message_;
-      p_image_crosstalk2_->header = *frame_header_message_;
-      p_image_saturated_->header = *frame_header_message_;
-      p_image_saturated2_->header = *frame_header_message_;
-      p_image_superimposed_->header = *frame_header_message_;
-      p_image_superimposed2_->header = *frame_header_message_;
-     
-      pub_ct_.publish(p_image_crosstalk_->toImageMsg(), flash_cam_info);
-      pub_ct2_.publish(p_image_crosstalk2_->toImageMsg(), flash_cam_info);
-      pub_sat_.publish(p_image_saturated_->toImageMsg(), flash_cam_info);
-      pub_sat2_.publish(p_image_saturated2_->toImageMsg(), flash_cam_info);
-      pub_si_.publish(p_image_superimposed_->toImageMsg(), flash_cam_info);
-      pub_si2_.publish(p_image_superimposed2_->toImageMsg(), flash_cam_info);
-      // iterators
-      sensor_msgs::PointCloud2Iterator<float> out_x(*pointcloud_, "x");
-      sensor_msgs::PointCloud2Iterator<float> out_y(*pointcloud_, "y");
-      sensor_msgs::PointCloud2Iterator<float> out_z(*pointcloud_, "z");
-      sensor_msgs::PointCloud2Iterator<float> out_i(*pointcloud_, "intensity");
-      sensor_msgs::PointCloud2Iterator<uint8_t> out_r(*pointcloud_, "return");
-      sensor_msgs::PointCloud2Iterator<uint8_t> out_ct(*pointcloud_, "crosstalk");
-      sensor_msgs::PointCloud2Iterator<uint8_t> out_sat(*pointcloud_, "saturated");
-      sensor_msgs::PointCloud2Iterator<uint8_t> out_si(*pointcloud_, "superimposed");
-
-      // loop through rows and cols
-      for (row_ = 0; row_ < FRAME_ROWS; row_ += 1)
+      slot.buffer->clearRow(row);
+      if (slot.outputs & output_points)
       {
-        for (col_ = 0; col_ < FRAME_COLUMNS; col_ += 1)
-        {
-          // Return 1
-          const cv::Vec3f &cvPoint =
-              transform_.at<cv::Vec3f>(col_, row_) *
-                    p_image_depth_->image.at<float>(cv::Point(col_, row_));
-
-          *out_x = cvPoint(0);
-          *out_y = cvPoint(1);
-          *out_z = cvPoint(2);
-          *out_i = p_image_intensity_->image.at<uint16_t>(cv::Point(col_, row_));
-          *out_r = 1;
-          *out_ct = p_image_crosstalk_->image.at<uint8_t>(cv::Point(col_, row_));
-          *out_sat = p_image_saturated_->image.at<uint8_t>(cv::Point(col_, row_));
-          *out_si = p_image_superimposed_->image.at<uint8_t>(cv::Point(col_, row_));
-
-          out_x += 1;
-          out_y += 1;
-          out_z += 1;
-          out_i += 1;
-          out_r += 1;
-          out_ct += 1;
-          out_sat += 1;
-          out_si += 1;
-
-          // Return 2
-          const cv::Vec3f &cvPoint2 = transform_.at<cv::Vec3f>(col_, row_) *
-                     p_image_depth2_->image.at<float>(cv::Point(col_, row_));
-
-          *out_x = cvPoint2(0);
-          *out_y = cvPoint2(1);
-          *out_z = cvPoint2(2);
-          *out_i = p_image_intensity2_->image.at<uint16_t>(cv::Point(col_, row_));
-          *out_r = 2;
-          *out_ct = p_image_crosstalk2_->image.at<uint8_t>(cv::Point(col_, row_));
-          *out_sat = p_image_saturated2_->image.at<uint8_t>(cv::Point(col_, row_));
-          *out_si = p_image_superimposed2_->image.at<uint8_t>(cv::Point(col_, row_));
-
-          out_x += 1;
-          out_y += 1;
-          out_z += 1;
-          out_i += 1;
-          out_r += 1;
-          out_ct += 1;
-          out_sat += 1;
-          out_si += 1;
-        }
+        projectRow(slot, row);
       }
+      if (slot.outputs & output_packed)
+      {
+        packed_layout_.clearRow(slot.packed->data.data(), row);
+      }
+    }
+  }
+}
+
+void HFL110DCU::publishFrame(FrameSlot& slot, uint32_t row_mask)
+{
+  StageTimer timer(profiler_.get());
+  if (row_mask != reassembler_->getFullMask())
+  {
+    fillMissingRows(slot, row_mask);
+  }
+
+  // Set header message, the offset may be reconfigured meanwhile
+  double time_offset = time_offset_;
+  if (clock_sync_enabled_)
+  {
+    frame_header_message_->stamp = ros::Time(clock_sync_.toHost(slot.sensor_time) + time_offset);
+  }
+  else
+  {
+    frame_header_message_->stamp = slot.stamp + ros::Duration(time_offset);
+  }
+  tf_header_message_->stamp = frame_header_message_->stamp;
+  // Objects are computed from this frame, hand the stamp to the object port
+  frame_stamp_ = frame_header_message_->stamp.toNSec();
+
+  // Stamp all messages of the frame, the slot lets go of them
+  FramePublication publication;
+  releaseMessages(slot, publication);
+  for (int plane = 0; plane < plane_count; plane += 1)
+  {
+    publication.images[plane]->header = *frame_header_message_;
+  }
+  publication.cloud->header = *frame_header_message_;
+  if (publication.packed)
+  {
+    publication.packed->header = *frame_header_message_;
+    publication.packed->row_valid = row_mask;
+  }
 
-      // publish transform
-      static tf2_ros::TransformBroadcaster br;
-      global_tf_.header = *tf_header_message_;
-      br.sendTransform(global_tf_);
+  // Camera info of the current calibration, shared by all images of the frame
+  publication.camera_info = camera_info_pool_->acquire<sensor_msgs::CameraInfoPtr>();
+  publication.camera_info->header = *frame_header_message_;
 
-      // publish pointcloud
-      pub_points_.publish(*pointcloud_);
+  // Row validity, one pixel per row, 255 if the row was received
+  if (publish_partial_frames_)
+  {
+    publication.row_valid = row_valid_pool_.acquire<sensor_msgs::ImagePtr>();
+    publication.row_valid->header = *frame_header_message_;
+    for (int row = 0; row < FRAME_ROWS; row += 1)
+    {
+      publication.row_valid->data[row] = ((row_mask >> row) & 1) * 255;
     }
-    expected_packet_ = (expected_packet_ > 0)? expected_packet_ - 1: FRAME_ROWS - 1;
   }
-  return true;
+
+  publication.transform = global_tf_;
+  publication.transform.header = *tf_header_message_;
+  publication.handoff_time = StageProfiler::now();
+
+  if (!publish_queue_)
+  {
+    publishMessages(publication, timer);
+  }
+  else if (!publish_queue_->push(std::move(publication)))
+  {
+    ROS_WARN_THROTTLE(1.0, "Publisher falling behind, frame dropped (%lu dropped)",
+                      publish_queue_->getDropCount());
+  }
+}
+
+void HFL110DCU::publishMessages(const FramePublication& publication, StageTimer& timer)
+{
+  // Images were decoded in place, publish them as they are
+  const sensor_msgs::CameraInfoPtr& flash_cam_info = publication.camera_info;
+  if (publication.outputs & output_ranges)
+  {
+    pub_depth_.publish(publication.images[plane_depth], flash_cam_info);
+    pub_intensity_.publish(publication.images[plane_intensity], flash_cam_info);
+    pub_depth2_.publish(publication.images[plane_depth2], flash_cam_info);
+    pub_intensity2_.publish(publication.images[plane_intensity2], flash_cam_info);
+  }
+  if (publication.outputs & output_flags)
+  {
+    pub_ct_.publish(publication.images[plane_crosstalk], flash_cam_info);
+    pub_ct2_.publish(publication.images[plane_crosstalk2], flash_cam_info);
+    pub_sat_.publish(publication.images[plane_saturated], flash_cam_info);
+    pub_sat2_.publish(publication.images[plane_saturated2], flash_cam_info);
+    pub_si_.publish(publication.images[plane_superimposed], flash_cam_info);
+    pub_si2_.publish(publication.images[plane_superimposed2], flash_cam_info);
+  }
+  if (publication.row_valid)
+  {
+    pub_row_valid_.publish(publication.row_valid, flash_cam_info);
+  }
+  timer.lap(stage_image_publish);
+
+  // publish transform
+  static tf2_ros::TransformBroadcaster br;
+  br.sendTransform(publication.transform);
+
+  // publish pointcloud, its rows were projected as they arrived
+  if (publication.outputs & output_points)
+  {
+    pub_points_.publish(publication.cloud);
+  }
+  timer.lap(stage_cloud_publish);
+
+  // All channels in one message, rows were packed as they arrived
+  if (publication.outputs & output_packed)
+  {
+    pub_packed_.publish(publication.packed);
+  }
+
+  // Only one thread publishes, plain updates are enough
+  uint64_t latency = StageProfiler::now() - publication.handoff_time;
+  publish_latency_total_.store(publish_latency_total_.load() + latency);
+  publish_count_.store(publish_count_.load() + 1);
+  if (latency > publish_latency_max_.load())
+  {
+    publish_latency_max_.store(latency);
+  }
 }
 
-bool HFL110DCU::parseObjects(int start_byte, const std::vector<uint8_t>& packet)
+void HFL110DCU::publishLoop()
+{
+  // The profiler belongs to the decode thread
+  StageTimer timer(nullptr);
+  FramePublication publication;
+  while (publish_queue_->pop(publication))
+  {
+    publishMessages(publication, timer);
+    // Messages go back to their pools once subscribers are done
+    publication = FramePublication();
+  }
+}
+
+bool HFL110DCU::parseObjects(int start_byte, PacketView packet)
 {
   int count = objects_.size();
   int last_object = 0;
@@ -495,73 +897,62 @@ bool HFL110DCU::parseObjects(int start_byte, const std::vector<uint8_t>& packet)
     last_object = 20;
   }
 
-  for (int i = start_byte; i < packet.size(); i += 129)
+  for (size_t i = start_byte; i + ObjectRecordLayoutV1::Record::size <= packet.size();
+       i += ObjectRecordLayoutV1::Record::size)
   {
     if (count == last_object)
     {
       break;
     }
+    ObjectRecordViewV1 record(&packet[i]);
     // create new object
     objects_.push_back(hflObj());
-    // object geometry attributes
-    objects_[count].geometry.x_rear_r = *reinterpret_cast<const float*>(&packet[i + 0]);
-    objects_[count].geometry.y_rear_r = *reinterpret_cast<const float*>(&packet[i + 4]);
-    objects_[count].geometry.x_rear_l = *reinterpret_cast<const float*>(&packet[i + 8]);
-    objects_[count].geometry.y_rear_l = *reinterpret_cast<const float*>(&packet[i + 12]);
-    objects_[count].geometry.x_front_l = *reinterpret_cast<const float*>(&packet[i + 16]);
-    objects_[count].geometry.y_front_l = *reinterpret_cast<const float*>(&packet[i + 20]);
-    objects_[count].geometry.height = *reinterpret_cast<const float*>(&packet[i + 24]);
-    objects_[count].geometry.ground_offset = *reinterpret_cast<const float*>(&packet[i + 28]);
-    objects_[count].geometry.fDistX = *reinterpret_cast<const float*>(&packet[i + 32]);
-    objects_[count].geometry.fDistY = *reinterpret_cast<const float*>(&packet[i + 36]);
-    objects_[count].geometry.yaw = *reinterpret_cast<const float*>(&packet[i + 40]);
-    // object kinematic attributes
-    objects_[count].kinematics.fVabsX = *reinterpret_cast<const float*>(&packet[i + 44]);
-    objects_[count].kinematics.fVabsY = *reinterpret_cast<const float*>(&packet[i + 48]);
-    objects_[count].kinematics.fVrelX = *reinterpret_cast<const float*>(&packet[i + 52]);
-    objects_[count].kinematics.fVrelY = *reinterpret_cast<const float*>(&packet[i + 56]);
-    objects_[count].kinematics.fAabsX = *reinterpret_cast<const float*>(&packet[i + 60]);
-    objects_[count].kinematics.fDistXDistY = *reinterpret_cast<const float*>(&packet[i + 64]);
-    objects_[count].kinematics.fDistXVx = *reinterpret_cast<const float*>(&packet[i + 68]);
-    objects_[count].kinematics.fDistXVy = *reinterpret_cast<const float*>(&packet[i + 72]);
-    objects_[count].kinematics.fDistXAx = *reinterpret_cast<const float*>(&packet[i + 76]);
-    objects_[count].kinematics.fDistXAy = *reinterpret_cast<const float*>(&packet[i + 80]);
-    objects_[count].kinematics.fDistYVx = *reinterpret_cast<const float*>(&packet[i + 84]);
-    objects_[count].kinematics.fDistYVy = *reinterpret_cast<const float*>(&packet[i + 88]);
-    objects_[count].kinematics.fDistYAx = *reinterpret_cast<const float*>(&packet[i + 92]);
-    objects_[count].kinematics.fDistYAy = *reinterpret_cast<const float*>(&packet[i + 96]);
-    objects_[count].kinematics.fVxVy = *reinterpret_cast<const float*>(&packet[i + 100]);
-    objects_[count].kinematics.fVxAx = *reinterpret_cast<const float*>(&packet[i + 104]);
-    objects_[count].kinematics.fVxAy = *reinterpret_cast<const float*>(&packet[i + 108]);
-    objects_[count].kinematics.fVyAx = *reinterpret_cast<const float*>(&packet[i + 112]);
-    objects_[count].kinematics.fVyAy = *reinterpret_cast<const float*>(&packet[i + 116]);
-    objects_[count].kinematics.fAxAy = *reinterpret_cast<const float*>(&packet[i + 120]);
+    // object geometry and kinematic attributes
+    ObjectRecordLayoutV1::Geometry::loadAll(record.at<ObjectRecordLayoutV1::Record>(),
+                                            objects_[count].geometry);
+    ObjectRecordLayoutV1::Kinematics::loadAll(record.at<ObjectRecordLayoutV1::Record>(),
+                                              objects_[count].kinematics);
     // object state
-    objects_[count].state = *reinterpret_cast<const hfl::objState*>(&packet[i + 124]);
-    objects_[count].dynamic_props = *reinterpret_cast<const hfl::objDyn*>(&packet[i + 125]);
-    objects_[count].quality = *reinterpret_cast<const uint8_t*>(&packet[i + 126]);
+    uint8_t state = record.get<ObjectRecordLayoutV1::State>();
+    uint8_t dynamic_props = record.get<ObjectRecordLayoutV1::DynamicProperties>();
+    memcpy(&objects_[count].state, &state, sizeof(state));
+    memcpy(&objects_[count].dynamic_props, &dynamic_props, sizeof(dynamic_props));
+    objects_[count].quality = record.get<ObjectRecordLayoutV1::Quality>();
     // object classification attributes
-    objects_[count].classification = *reinterpret_cast<const uint8_t*>(&packet[i + 127]);
-    objects_[count].confidence = *reinterpret_cast<const uint8_t*>(&packet[i + 128]);
+    objects_[count].classification = record.get<ObjectRecordLayoutV1::Classification>();
+    objects_[count].confidence = record.get<ObjectRecordLayoutV1::Confidence>();
     count += 1;
   }
 
   return true;
 }
 
-bool HFL110DCU::processObjectData(const std::vector<uint8_t>& object_data)
+bool HFL110DCU::processObjectDataV1(PacketView object_data)
 {
-  // grab the time when recieved packet
-  object_header_message_->stamp = ros::Time::now();
-  object_header_message_->seq += 1;
+  StageTimer timer(profiler_.get());
 
   // identify packet by fragmentation offset
-  uint32_t obj_packet =
-      (big_to_native(*reinterpret_cast<const uint32_t*>(&object_data[10])) >> 0) & 1;
+  if (!ObjectViewV1::fits<ObjectLayoutV1::PacketIndex>(object_data))
+  {
+    return false;
+  }
+
+  // stamp objects with the frame they were detected in
+  uint64_t frame_stamp = frame_stamp_;
+  object_header_message_->stamp = frame_stamp ?
+    ros::Time().fromNSec(frame_stamp) : receiveStamp(object_data);
+  object_header_message_->seq += 1;
 
-  parseObjects(14, object_data);
+  uint32_t obj_packet = ObjectViewV1(object_data).get<ObjectLayoutV1::PacketIndex>() & 1;
 
-  if (obj_packet == 1)
+  parseObjects(ObjectLayoutV1::Records::offset, object_data);
+
+  // Markers are only built while someone listens
+  if (obj_packet == 1 && !(outputs_ & output_objects))
+  {
+    objects_.clear();
+  }
+  else if (obj_packet == 1)
   {
     visualization_msgs::Marker bBox;
     visualization_msgs::MarkerArray marker_array;
@@ -670,43 +1061,39 @@ bool HFL110DCU::processObjectData(const std::vector<uint8_t>& object_data)
     pub_objects_.publish(marker_array);
     objects_.clear();
   }
+  timer.lap(stage_object_decode);
 
   return true;
 }
 
-bool HFL110DCU::processTelemetryData(const std::vector<uint8_t>& tele_data)
+bool HFL110DCU::processTelemetryDataV1(PacketView tele_data)
 {
   // grab the time when recieved packet
-  tele_header_message_->stamp = ros::Time::now();
+  tele_header_message_->stamp = receiveStamp(tele_data);
   tele_header_message_->seq += 1;
 
-  telem_.uiHardwareRevision = 
-    (big_to_native(*reinterpret_cast<const uint32_t*>(&tele_data[0])));
-  telem_.fSensorTemp =
-    (*reinterpret_cast<const float*>(&tele_data[4]));
-  telem_.fHeaterTemp =
-    (-*reinterpret_cast<const float*>(&tele_data[8]));
-  telem_.uiFrameCounter =
-    (big_to_native(*reinterpret_cast<const uint32_t*>(&tele_data[12])));
-  telem_.fADCUbattSW =
-    (*reinterpret_cast<const float*>(&tele_data[16]));
-  telem_.fADCUbatt =
-    (*reinterpret_cast<const float*>(&tele_data[20]));
-  telem_.fADCHeaterLens =
-    (*reinterpret_cast<const float*>(&tele_data[24]));
-  telem_.fADCHeaterLensHigh =
-    (*reinterpret_cast<const float*>(&tele_data[28]));
-  telem_.fADCTemp0Lens =
-    (*reinterpret_cast<const float*>(&tele_data[32]));
-  telem_.fAcquisitionPeriod =
-    (*reinterpret_cast<const float*>(&tele_data[36]));
-  telem_.uiTempSensorFeedback =
-    (unsigned(*reinterpret_cast<const uint8_t*>(&tele_data[40])));
-  
-  for (int i = 25; i >= 0; i--)
+  if (!TelemetryViewV1::fits<TelemetryLayoutV1::Packet>(tele_data))
+  {
+    return false;
+  }
+  TelemetryViewV1 tele(tele_data);
+  telem_.uiHardwareRevision = tele.get<TelemetryLayoutV1::HardwareRevision>();
+  telem_.fSensorTemp = tele.get<TelemetryLayoutV1::SensorTemperature>();
+  telem_.fHeaterTemp = -tele.get<TelemetryLayoutV1::HeaterTemperature>();
+  telem_.uiFrameCounter = tele.get<TelemetryLayoutV1::FrameCounter>();
+  telem_.fADCUbattSW = tele.get<TelemetryLayoutV1::UbattSwitched>();
+  telem_.fADCUbatt = tele.get<TelemetryLayoutV1::Ubatt>();
+  telem_.fADCHeaterLens = tele.get<TelemetryLayoutV1::HeaterLens>();
+  telem_.fADCHeaterLensHigh = tele.get<TelemetryLayoutV1::HeaterLensHigh>();
+  telem_.fADCTemp0Lens = tele.get<TelemetryLayoutV1::Temperature0Lens>();
+  telem_.fAcquisitionPeriod = tele.get<TelemetryLayoutV1::AcquisitionPeriod>();
+  telem_.uiTempSensorFeedback = tele.get<TelemetryLayoutV1::TemperatureSensorFeedback>();
+
+  // serial number is sent in reverse character order
+  for (size_t i = 0; i < TelemetryLayoutV1::SerialNumber::count; i += 1)
   {
-    telem_.au8SerialNumber[25 - i] =
-      (*reinterpret_cast<const char*>(&tele_data[41 + i]));
+    telem_.au8SerialNumber[i] =
+      tele.get<TelemetryLayoutV1::SerialNumber>(TelemetryLayoutV1::SerialNumber::count - 1 - i);
   }
 
   //ROS_INFO("sensor temp: %u", *reinterpret_cast<const uint8_t*>(&tele_data[40]));
@@ -716,7 +1103,7 @@ bool HFL110DCU::processTelemetryData(const std::vector<uint8_t>& tele_data)
   return true;
 }
 
-bool HFL110DCU::processSliceData(const std::vector<uint8_t>& slice_data)
+bool HFL110DCU::processSliceDataV1(PacketView slice_data)
 {
   // INTERNAL
   return true;
@@ -783,6 +1170,57 @@ void HFL110DCU::update_diagnostics(diagnostic_updater::DiagnosticStatusWrapper &
   // TODO(flynneva): should reset HardwareID using this serial number
   stat.add("au8SerialNumber", telem_.au8SerialNumber);
 
+  // frame reassembly counters, runs on the telemetry port so frame port
+  // state is read from its snapshot
+  const FrameDiagnostics& frame = frame_diagnostics_;
+  stat.add("frames completed", frame.frames_completed.load(std::memory_order_relaxed));
+  stat.add("frames evicted", frame.frames_evicted.load(std::memory_order_relaxed));
+  stat.add("late rows", frame.late_rows.load(std::memory_order_relaxed));
+  stat.add("duplicate rows", frame.duplicate_rows.load(std::memory_order_relaxed));
+  stat.add("publish partial frames", publish_partial_frames_);
+  stat.addf("outputs", "0x%x", unsigned(outputs_));
+
+  // publisher stage
+  uint64_t publish_count = publish_count_;
+  stat.add("published frames", publish_count);
+  stat.add("publish latency mean [ms]", publish_count ? publish_latency_total_ * 1e-6 / publish_count : 0.0);
+  stat.add("publish latency max [ms]", publish_latency_max_ * 1e-6);
+  if (publish_queue_)
+  {
+    stat.add("publish queue depth", publish_queue_->depth());
+    stat.add("publish queue max depth", publish_queue_->getMaxDepth());
+    stat.add("publish queue dropped frames", publish_queue_->getDropCount());
+  }
+
+  // sensor clock synchronization
+  stat.add("clock sync", clock_sync_enabled_);
+  stat.add("clock offset [s]", frame.clock_offset.load(std::memory_order_relaxed));
+  stat.add("clock drift [ppm]", frame.clock_drift.load(std::memory_order_relaxed) * 1e6);
+  stat.add("clock resets", frame.clock_resets.load(std::memory_order_relaxed));
+
+  // message pools
+  size_t image_pool_size = row_valid_pool_.getSize();
+  uint64_t image_pool_misses = row_valid_pool_.getMisses();
+  for (const auto& pool : image_pools_)
+  {
+    image_pool_size += pool->getSize();
+    image_pool_misses += pool->getMisses();
+  }
+  stat.add("image pool size", image_pool_size);
+  stat.add("image pool misses", image_pool_misses);
+  stat.add("cloud pool size", cloud_pool_.getSize());
+  stat.add("cloud pool misses", cloud_pool_.getMisses());
+  if (packed_pool_)
+  {
+    stat.add("packed frame pool size", packed_pool_->getSize());
+    stat.add("packed frame pool misses", packed_pool_->getMisses());
+  }
+
+  // sensor calibration
+  stat.add("calibration epoch", frame.calibration_epoch.load(std::memory_order_relaxed));
+  stat.addf("calibration hash", "%016llx",
+            (unsigned long long)frame.calibration_hash.load(std::memory_order_relaxed));
+
   // TODO(flynneva): add some logic here to check if everything is ok
   stat.level = diagnostic_msgs::DiagnosticStatus::OK;
   stat.message = "OK";
@@ -0,0 +1,152 @@
+// Copyright 2020 Continental AG
+// All rights reserved.
+//
+// Software License Agreement (BSD 2-Clause Simplified License)
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above
+//    copyright notice, this list of conditions and the following
+//    disclaimer in the documentation and/or other materials provided
+//    with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+///
+/// @file hfl_replay.cpp
+///
+/// @brief This file implements the packet log replay tool.
+///
+/// Feeds a recorded packet log through the image processor and reports
+/// throughput and per stage timing. Usage:
+///
+///   rosrun hfl_driver hfl_replay <packet log> [_rate:=1.0] [_loops:=1]
+///
+/// _rate scales the recorded packet timing, 0 replays unthrottled.
+///
+#include "image_processor/hfl110dcu.h"
+
+#include <packet_log.h>
+#include <stage_profiler.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "ros/ros.h"
+
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "hfl_replay");
+  if (argc < 2)
+  {
+    ROS_ERROR("Usage: hfl_replay <packet log> [_rate:=1.0] [_loops:=1]");
+    return 1;
+  }
+  ros::NodeHandle node_handler("~");
+
+  std::string model, version, frame_id;
+  double rate;
+  int loops;
+  node_handler.param<std::string>("model", model, "hfl110dcu");
+  node_handler.param<std::string>("version", version, "v1");
+  node_handler.param<std::string>("frame_id", frame_id, "hfl110dcu");
+  node_handler.param("rate", rate, 1.0);
+  node_handler.param("loops", loops, 1);
+
+  hfl::PacketLogReader reader;
+  if (!reader.open(argv[1]))
+  {
+    return 1;
+  }
+
+  // Time every stage, also without subscribers
+  if (!node_handler.hasParam("lazy_outputs"))
+  {
+    node_handler.setParam("lazy_outputs", false);
+  }
+  // Publish on this thread so publishing is timed too
+  if (!node_handler.hasParam("publish_queue"))
+  {
+    node_handler.setParam("publish_queue", 0);
+  }
+  std::shared_ptr<hfl::HFL110DCU> flash(new hfl::HFL110DCU(model, version, frame_id, node_handler));
+  std::shared_ptr<hfl::StageProfiler> profiler(new hfl::StageProfiler(hfl::FRAME_STAGE_NAMES));
+  flash->setProfiler(profiler);
+
+  const char* channel_names[hfl::channel_count] = { "frame", "pdm", "object", "tele", "slice" };
+  uint64_t packet_count[hfl::channel_count] = {};
+  uint64_t packet_time[hfl::channel_count] = {};
+  uint64_t processing_time = 0;
+
+  hfl::PacketBuffer buffer;
+  hfl::packet_channel channel;
+  uint64_t replay_start = hfl::StageProfiler::now();
+  for (int loop = 0; loop < loops && ros::ok(); loop += 1)
+  {
+    // Pace relative to the first packet of every loop
+    uint64_t first_receive_time = 0;
+    uint64_t loop_start = hfl::StageProfiler::now();
+    while (ros::ok() && reader.read(buffer, channel))
+    {
+      if (rate > 0.0 && buffer.receive_time != 0)
+      {
+        if (first_receive_time == 0)
+        {
+          first_receive_time = buffer.receive_time;
+        }
+        uint64_t due = loop_start + uint64_t((buffer.receive_time - first_receive_time) / rate);
+        uint64_t now = hfl::StageProfiler::now();
+        if (due > now)
+        {
+          std::this_thread::sleep_for(std::chrono::nanoseconds(due - now));
+        }
+      }
+
+      uint64_t start = hfl::StageProfiler::now();
+      flash->processPacket(channel, buffer.view());
+      uint64_t elapsed = hfl::StageProfiler::now() - start;
+      packet_count[channel] += 1;
+      packet_time[channel] += elapsed;
+      processing_time += elapsed;
+    }
+    reader.rewind();
+  }
+  double wall_time = (hfl::StageProfiler::now() - replay_start) * 1e-9;
+
+  // Report
+  uint64_t frames = profiler->getCount(hfl::stage_cloud_publish);
+  ROS_INFO("Replayed %s: %lu frames in %.3f s (%.1f frames/s wall, %.1f frames/s processing)",
+           argv[1], frames, wall_time, frames / wall_time,
+           processing_time ? frames / (processing_time * 1e-9) : 0.0);
+  for (int i = 0; i < hfl::channel_count; i += 1)
+  {
+    if (packet_count[i] > 0)
+    {
+      ROS_INFO("  %-8s %10lu packets %10.0f ns/packet", channel_names[i], packet_count[i],
+               double(packet_time[i]) / packet_count[i]);
+    }
+  }
+  for (size_t stage = 0; stage < profiler->size(); stage += 1)
+  {
+    ROS_INFO("  %-14s %10.0f ns/frame %10lu calls", profiler->getName(stage).c_str(),
+             frames ? double(profiler->getTotal(stage)) / frames : 0.0, profiler->getCount(stage));
+  }
+  return 0;
+}
@@ -39,6 +39,32 @@
 
 #include <gtest/gtest.h>
 #include <base_hfl110dcu.h>
+#include <bounded_queue.h>
+#include <calibration_monitor.h>
+#include <clock_sync.h>
+#include <decoder_registry.h>
+#include <depth_codec.h>
+#include <frame_buffer.h>
+#include <frame_reassembler.h>
+#include <hfl_packet.h>
+#include <message_pool.h>
+#include <packed_frame.h>
+#include <packet_encoder.h>
+#include <packet_layout.h>
+#include <packet_log.h>
+#include <packet_recorder.h>
+#include <point_projector.h>
+#include <range_table.h>
+#include <row_decoder.h>
+#include <unistd.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
 #include <vector>
 
 // create dummy HFL110DCU class
@@ -61,12 +87,12 @@ public:
   // NOTE: these are the functions that will need to be written
   // in the actual image_processor classes
   //
-  bool parseFrame(int start_byte, const std::vector<unsigned char>&) override
+  bool parseFrame(int start_byte, hfl::PacketView) override
   {
     return true;
   };
   // TODO(evan_flynn): should this return a bool to indicate status?
-  bool processFrameData(const std::vector<uint8_t>& data) override
+  bool processFrameData(hfl::PacketView data) override
   {
     return true;
   };
@@ -134,3 +160,727 @@ TEST_F(HFL110DCUFixture, testVersionParam)
   ASSERT_EQ(true, true);
 }
 
+TEST(PacketPoolTestSuite, testRingWrapsAround)
+{
+  hfl::PacketPool pool(100);
+  // Capacity is rounded up to a power of two
+  ASSERT_EQ(pool.capacity(), 128u);
+  ASSERT_EQ(&pool.at(3), &pool.at(3 + pool.capacity()));
+}
+
+TEST(PacketPoolTestSuite, testViewMatchesVector)
+{
+  std::vector<uint8_t> data = { 1, 2, 3 };
+  hfl::PacketView view(data);
+  ASSERT_EQ(view.size(), data.size());
+  ASSERT_EQ(view[2], 3);
+}
+
+TEST(PacketPoolTestSuite, testViewCarriesReceiveTime)
+{
+  hfl::PacketBuffer buffer;
+  buffer.size = 4;
+  buffer.receive_time = 1234567890123456789ULL;
+  ASSERT_EQ(buffer.view().getReceiveTime(), buffer.receive_time);
+  // Vectors from udp_com have no kernel timestamp
+  std::vector<uint8_t> data = { 1 };
+  ASSERT_EQ(hfl::PacketView(data).getReceiveTime(), 0u);
+}
+
+TEST(FrameReassemblerTestSuite, testOutOfOrderRowsComplete)
+{
+  hfl::FrameReassembler reassembler(4, 2, 0.1);
+  uint16_t rows[] = { 2, 0, 3, 1 };
+  hfl::RowInsertion result;
+  for (uint16_t row : rows)
+  {
+    result = reassembler.insert(7, row, 0.0);
+    ASSERT_EQ(result.status, hfl::row_accepted);
+  }
+  ASSERT_TRUE(result.complete);
+  ASSERT_EQ(reassembler.getCompletedCount(), 1u);
+  // Rows of a completed frame are late
+  ASSERT_EQ(reassembler.insert(7, 0, 0.0).status, hfl::row_late);
+}
+
+TEST(FrameReassemblerTestSuite, testInterleavedFrames)
+{
+  hfl::FrameReassembler reassembler(2, 2, 0.1);
+  ASSERT_TRUE(reassembler.insert(1, 0, 0.0).started);
+  ASSERT_TRUE(reassembler.insert(2, 0, 0.0).started);
+  ASSERT_EQ(reassembler.insert(2, 0, 0.0).status, hfl::row_duplicate);
+  ASSERT_TRUE(reassembler.insert(1, 1, 0.0).complete);
+  ASSERT_TRUE(reassembler.insert(2, 1, 0.0).complete);
+  ASSERT_EQ(reassembler.getEvictedCount(), 0u);
+}
+
+TEST(FrameReassemblerTestSuite, testEviction)
+{
+  hfl::FrameReassembler reassembler(2, 2, 0.1);
+  reassembler.insert(1, 0, 0.0);
+  reassembler.insert(2, 0, 0.0);
+  // Third frame pushes out the oldest one
+  hfl::RowInsertion result = reassembler.insert(3, 1, 0.0);
+  ASSERT_TRUE(result.evicted);
+  ASSERT_EQ(result.evicted_frame.frame_number, 1u);
+  ASSERT_EQ(result.evicted_frame.row_mask, 1u);
+  // Frames 2 and 3 time out
+  hfl::FrameSlotInfo frame;
+  ASSERT_TRUE(reassembler.expire(0.15, frame));
+  ASSERT_TRUE(reassembler.expire(0.15, frame));
+  ASSERT_FALSE(reassembler.expire(0.15, frame));
+  ASSERT_EQ(reassembler.getEvictedCount(), 3u);
+  ASSERT_EQ(reassembler.insert(1, 1, 0.2).status, hfl::row_late);
+}
+
+TEST(ClockSyncTestSuite, testOffsetAndDrift)
+{
+  hfl::ClockSync sync(1e-6, 32, 1.0);
+  // Sensor clock runs 50 ppm slow and starts 1000 s behind the host
+  const double drift = 50e-6;
+  const double offset = 1000.0;
+  const double min_delay = 0.001;
+  uint64_t sensor_ticks = 0;
+  for (int i = 0; i < 2000; i += 1)
+  {
+    sensor_ticks = uint64_t(i) * 10000;
+    double sensor = sensor_ticks * 1e-6;
+    // Delays between 1 and 6 ms, every 7th sample with the minimum delay
+    double delay = min_delay + ((i % 7) ? 0.005 * ((i * 37) % 11) / 10.0 : 0.0);
+    sync.addSample(sensor_ticks, offset + sensor * (1.0 + drift) + delay);
+  }
+  double sensor = sensor_ticks * 1e-6;
+  ASSERT_NEAR(sync.getDrift(), drift, 1e-6);
+  ASSERT_NEAR(sync.toHost(sensor_ticks), offset + sensor * (1.0 + drift) + min_delay, 1e-4);
+}
+
+TEST(ClockSyncTestSuite, testResetOnJump)
+{
+  hfl::ClockSync sync(1e-6, 32, 1.0);
+  sync.addSample(1000000, 10.0);
+  sync.addSample(2000000, 11.0);
+  // Sensor rebooted, its clock starts over
+  sync.addSample(0, 12.0);
+  ASSERT_EQ(sync.getResetCount(), 1u);
+  ASSERT_NEAR(sync.toHost(500000), 12.5, 1e-9);
+}
+
+// Unique log file, removed even when an assertion ends the test early
+struct TemporaryFile
+{
+  explicit TemporaryFile(const std::string& prefix)
+  {
+    std::string name = "/tmp/" + prefix + "_XXXXXX";
+    std::vector<char> buffer(name.begin(), name.end());
+    buffer.push_back('\0');
+    int fd = mkstemp(buffer.data());
+    if (fd >= 0)
+    {
+      ::close(fd);
+      path = buffer.data();
+    }
+  }
+  ~TemporaryFile()
+  {
+    if (!path.empty())
+    {
+      std::remove(path.c_str());
+    }
+  }
+  std::string path;
+};
+
+TEST(PacketLogTestSuite, testRoundTrip)
+{
+  TemporaryFile file("hfl_packet_log_test");
+  ASSERT_FALSE(file.path.empty());
+  const std::string& path = file.path;
+  std::vector<uint8_t> frame(1100, 7);
+  std::vector<uint8_t> object = { 1, 2, 3 };
+  hfl::PacketLogWriter writer;
+  ASSERT_TRUE(writer.open(path));
+  ASSERT_TRUE(writer.write(hfl::channel_frame, hfl::PacketView(frame.data(), frame.size(), 42)));
+  ASSERT_TRUE(writer.write(hfl::channel_object, object));
+  writer.close();
+
+  hfl::PacketLogReader reader;
+  hfl::PacketBuffer buffer;
+  hfl::packet_channel channel;
+  ASSERT_TRUE(reader.open(path));
+  ASSERT_TRUE(reader.read(buffer, channel));
+  ASSERT_EQ(channel, hfl::channel_frame);
+  ASSERT_EQ(buffer.size, frame.size());
+  ASSERT_EQ(buffer.receive_time, 42u);
+  ASSERT_TRUE(reader.read(buffer, channel));
+  ASSERT_EQ(channel, hfl::channel_object);
+  ASSERT_EQ(buffer.data[2], 3);
+  ASSERT_FALSE(reader.read(buffer, channel));
+  // Replays start over after a rewind
+  reader.rewind();
+  ASSERT_TRUE(reader.read(buffer, channel));
+  ASSERT_EQ(channel, hfl::channel_frame);
+}
+
+TEST(PacketEncoderTestSuite, testFrameRowLayout)
+{
+  hfl::SensorCalibration calibration;
+  calibration.fx = 36.5f;
+  calibration.extrinsic_x = 2.0f;
+  hfl::PacketEncoder encoder(calibration);
+  hfl::FrameRowData row = {};
+  row.range[5][0] = 0x0a00;
+  row.flags[127] = 0x81;
+  hfl::PacketBuffer buffer;
+  encoder.encodeFrameRow(buffer, 0x01020304, 31, 0x1122334455667788ULL, row);
+  hfl::PacketView packet = buffer.view();
+
+  ASSERT_EQ(packet.size(), hfl::FRAME_PACKET_SIZE);
+  // Header fields are big endian, calibration floats little endian
+  hfl::FrameViewV1 frame(packet);
+  ASSERT_EQ(frame.get<hfl::FrameLayoutV1::FrameNumber>(), 0x01020304u);
+  ASSERT_EQ(frame.get<hfl::FrameLayoutV1::RowNumber>(), 31u);
+  ASSERT_EQ(frame.get<hfl::FrameLayoutV1::Timestamp>(), 0x1122334455667788ULL);
+  ASSERT_EQ(frame.get<hfl::FrameLayoutV1::Fx>(), 36.5f);
+  ASSERT_EQ(frame.get<hfl::FrameLayoutV1::ExtrinsicX>(), 2.0f);
+  // Pixel data, ranges of both returns interleaved
+  ASSERT_EQ(frame.get<hfl::FrameLayoutV1::Ranges>(5 * 2), 0x0a00);
+  ASSERT_EQ(frame.get<hfl::FrameLayoutV1::Flags>(127), 0x81);
+}
+
+TEST(PacketRecorderTestSuite, testRecordAndFeed)
+{
+  // Counts the packets fed back from the log
+  class CountingHFL110DCU : public hfl::BaseHFL110DCU
+  {
+  public:
+    bool parseFrame(int, hfl::PacketView) override { return true; }
+    bool processFrameData(hfl::PacketView) override { frames += 1; return true; }
+    bool parseObjects(int, hfl::PacketView) override { return true; }
+    bool processObjectData(hfl::PacketView) override { return true; }
+    bool processTelemetryData(hfl::PacketView) override { telemetry += 1; return true; }
+    bool processSliceData(hfl::PacketView) override { return true; }
+    size_t frames = 0;
+    size_t telemetry = 0;
+  };
+
+  TemporaryFile file("hfl_packet_recorder_test");
+  ASSERT_FALSE(file.path.empty());
+  const std::string& path = file.path;
+  std::vector<uint8_t> frame(1372, 1);
+  std::vector<uint8_t> tele(67, 2);
+  hfl::PacketRecorder recorder(16384, 4);
+  ASSERT_TRUE(recorder.open(path));
+  for (int i = 0; i < 1000; i += 1)
+  {
+    recorder.record(hfl::channel_frame, frame);
+    if (i % 100 == 0)
+    {
+      recorder.record(hfl::channel_tele, tele);
+    }
+  }
+  recorder.close();
+  ASSERT_EQ(recorder.getRecordedCount() + recorder.getDroppedCount(), 1010u);
+
+  // Everything recorded can be read back and processed
+  hfl::PacketLogReader reader;
+  CountingHFL110DCU camera;
+  ASSERT_TRUE(reader.open(path));
+  ASSERT_EQ(reader.feed(camera), recorder.getRecordedCount());
+  ASSERT_EQ(camera.frames + camera.telemetry, recorder.getRecordedCount());
+}
+
+TEST(RowDecoderTestSuite, testKernelsMatchScalar)
+{
+  hfl::FrameRowData row = {};
+  for (size_t col = 0; col < hfl::ENCODER_COLUMNS; col += 1)
+  {
+    row.range[col][0] = uint16_t(col * 131);
+    row.range[col][1] = uint16_t(65535 - col * 97);
+    row.intensity[col][0] = uint16_t(col * 509);
+    row.intensity[col][1] = uint16_t(col);
+  }
+  hfl::PacketEncoder encoder;
+  hfl::PacketBuffer buffer;
+  encoder.encodeFrameRow(buffer, 0, 0, 0, row);
+
+  std::vector<float> range_1(hfl::ROW_COLUMNS), range_2(hfl::ROW_COLUMNS);
+  std::vector<uint16_t> intensity_1(hfl::ROW_COLUMNS), intensity_2(hfl::ROW_COLUMNS);
+  hfl::DecodedRow out;
+  out.range_1 = range_1.data();
+  out.range_2 = range_2.data();
+  out.intensity_1 = intensity_1.data();
+  out.intensity_2 = intensity_2.data();
+  hfl::RangeTable range_table(256.0f);
+  const hfl::row_decoder_isa kernels[] = { hfl::isa_scalar, hfl::isa_sse41, hfl::isa_avx2 };
+  for (hfl::row_decoder_isa isa : kernels)
+  {
+    hfl::RowDecoder decoder(isa);
+    hfl::RangeTable::Reader range(range_table);
+    decoder.decode(&buffer.data[hfl::FRAME_DATA_OFFSET], range.get(), out);
+    for (size_t col = 0; col < hfl::ROW_COLUMNS; col += 1)
+    {
+      float expected_1 = (256.0f + row.range[col][0]) / 256.0f;
+      float expected_2 = (256.0f + row.range[col][1]) / 256.0f;
+      if (expected_1 > 49.0f)
+        ASSERT_TRUE(std::isnan(range_1[col]));
+      else
+        ASSERT_EQ(range_1[col], expected_1);
+      if (expected_2 > 49.0f)
+        ASSERT_TRUE(std::isnan(range_2[col]));
+      else
+        ASSERT_EQ(range_2[col], expected_2);
+      ASSERT_EQ(intensity_1[col], row.intensity[col][0]);
+      ASSERT_EQ(intensity_2[col], row.intensity[col][1]);
+    }
+  }
+}
+
+TEST(RowDecoderTestSuite, testFlagKernelsMatchScalar)
+{
+  std::vector<uint8_t> row(hfl::ROW_COLUMNS);
+  for (size_t col = 0; col < hfl::ROW_COLUMNS; col += 1)
+  {
+    row[col] = uint8_t(col * 37 + 11);
+  }
+
+  std::vector<uint8_t> planes(6 * hfl::ROW_COLUMNS);
+  hfl::DecodedFlags flags;
+  flags.crosstalk = &planes[0 * hfl::ROW_COLUMNS];
+  flags.saturated = &planes[1 * hfl::ROW_COLUMNS];
+  flags.superimposed = &planes[2 * hfl::ROW_COLUMNS];
+  flags.crosstalk_2 = &planes[3 * hfl::ROW_COLUMNS];
+  flags.saturated_2 = &planes[4 * hfl::ROW_COLUMNS];
+  flags.superimposed_2 = &planes[5 * hfl::ROW_COLUMNS];
+  const uint8_t plane_bits[] = { 0, 1, 3, 4, 5, 7 };
+  std::vector<uint8_t> bits(8 * hfl::ROW_FLAG_PLANE_SIZE);
+  const hfl::row_decoder_isa kernels[] = { hfl::isa_scalar, hfl::isa_sse41, hfl::isa_avx2 };
+  for (hfl::row_decoder_isa isa : kernels)
+  {
+    hfl::RowDecoder decoder(isa);
+    decoder.unpackFlags(row.data(), flags);
+    decoder.packFlags(row.data(), bits.data());
+    for (size_t col = 0; col < hfl::ROW_COLUMNS; col += 1)
+    {
+      for (size_t plane = 0; plane < 6; plane += 1)
+      {
+        ASSERT_EQ(planes[plane * hfl::ROW_COLUMNS + col], ((row[col] >> plane_bits[plane]) & 1) * 255);
+      }
+      for (size_t bit = 0; bit < 8; bit += 1)
+      {
+        ASSERT_EQ((bits[bit * hfl::ROW_FLAG_PLANE_SIZE + col / 8] >> (col % 8)) & 1, (row[col] >> bit) & 1);
+      }
+    }
+  }
+}
+
+TEST(FrameBufferTestSuite, testPlanesAlignedAndCleared)
+{
+  hfl::FrameBuffer buffer(32, 128);
+  for (int plane = 0; plane < hfl::plane_count; plane += 1)
+  {
+    uint8_t* data = buffer.getPlane(hfl::frame_plane(plane));
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(data) % hfl::FRAME_BUFFER_ALIGNMENT, 0u);
+    memset(data, 0x7f, 32 * buffer.getStep(hfl::frame_plane(plane)));
+  }
+  ASSERT_EQ(buffer.getStep(hfl::plane_depth), 512u);
+  ASSERT_EQ(buffer.getStep(hfl::plane_intensity2), 256u);
+  ASSERT_EQ(buffer.getStep(hfl::plane_superimposed2), 128u);
+
+  // Only the cleared row is reset
+  buffer.clearRow(5);
+  ASSERT_TRUE(std::isnan(buffer.getRow<float>(hfl::plane_depth2, 5)[127]));
+  ASSERT_EQ(buffer.getRow<uint16_t>(hfl::plane_intensity, 5)[0], 0);
+  ASSERT_EQ(buffer.getRow<uint8_t>(hfl::plane_saturated, 5)[64], 0);
+  ASSERT_EQ(buffer.getRow<uint8_t>(hfl::plane_saturated, 4)[64], 0x7f);
+  ASSERT_EQ(buffer.getRow<uint8_t>(hfl::plane_saturated, 6)[0], 0x7f);
+}
+
+TEST(FrameBufferTestSuite, testBoundPlanesWriteInPlace)
+{
+  hfl::FrameBuffer buffer(32, 128);
+  uint8_t* own = buffer.getPlane(hfl::plane_intensity);
+  std::vector<uint8_t> message(32 * buffer.getStep(hfl::plane_intensity), 0x7f);
+
+  buffer.bindPlane(hfl::plane_intensity, message.data());
+  ASSERT_EQ(buffer.getRow<uint16_t>(hfl::plane_intensity, 1), reinterpret_cast<uint16_t*>(&message[256]));
+  buffer.clearRow(1);
+  ASSERT_EQ(message[255], 0x7f);
+  ASSERT_EQ(message[256], 0);
+  ASSERT_EQ(message[511], 0);
+  ASSERT_EQ(message[512], 0x7f);
+
+  buffer.bindPlane(hfl::plane_intensity, nullptr);
+  ASSERT_EQ(buffer.getPlane(hfl::plane_intensity), own);
+
+  // Without an allocation planes only exist while bound
+  hfl::FrameBuffer views(32, 128, false);
+  ASSERT_EQ(views.getSize(), 0u);
+  ASSERT_EQ(views.getPlane(hfl::plane_intensity), nullptr);
+  views.bindPlane(hfl::plane_intensity, message.data());
+  ASSERT_EQ(views.getRow<uint16_t>(hfl::plane_intensity, 1), reinterpret_cast<uint16_t*>(&message[256]));
+  views.bindPlane(hfl::plane_intensity, nullptr);
+  ASSERT_EQ(views.getPlane(hfl::plane_intensity), nullptr);
+}
+
+TEST(PacketLayoutTestSuite, testViewsReadEncodedPackets)
+{
+  hfl::SensorCalibration calibration;
+  calibration.fy = 36.5f;
+  calibration.extrinsic_x = 2.0f;
+  hfl::PacketEncoder encoder(calibration);
+  hfl::FrameRowData row = {};
+  row.range[3][1] = 0x0a0b;
+  row.intensity[127][0] = 0x1234;
+  row.flags[64] = 0x81;
+  hfl::PacketBuffer buffer;
+  encoder.encodeFrameRow(buffer, 0x01020304, 31, 0x1122334455667788ULL, row);
+
+  typedef hfl::FrameLayoutV1 Frame;
+  ASSERT_TRUE(hfl::FrameViewV1::fits<Frame::Packet>(buffer.view()));
+  ASSERT_FALSE(hfl::FrameViewV1::fits<Frame::Packet>(hfl::PacketView(buffer.data, 1371)));
+  // Views need no alignment
+  hfl::FrameViewV1 frame(buffer.view());
+  ASSERT_EQ(frame.get<Frame::FrameNumber>(), 0x01020304u);
+  ASSERT_EQ(frame.get<Frame::RowNumber>(), 31u);
+  ASSERT_EQ(frame.get<Frame::Timestamp>(), 0x1122334455667788ULL);
+  ASSERT_EQ(frame.get<Frame::Fy>(), 36.5f);
+  ASSERT_EQ(frame.get<Frame::ExtrinsicX>(), 2.0f);
+  ASSERT_EQ(frame.get<Frame::Ranges>(7), 0x0a0b);
+  ASSERT_EQ(frame.get<Frame::Intensities>(254), 0x1234);
+  ASSERT_EQ(frame.get<Frame::Flags>(64), 0x81);
+
+  hfl::EncodedObject object;
+  object.x = 10.0f;
+  object.vy = -1.5f;
+  object.confidence = 90;
+  encoder.encodeObjects(buffer, &object, 1, true);
+  ASSERT_EQ(hfl::ObjectViewV1(buffer.view()).get<hfl::ObjectLayoutV1::PacketIndex>(), 1u);
+  typedef hfl::ObjectRecordLayoutV1 Record;
+  hfl::ObjectRecordViewV1 record(buffer.view().data() + hfl::ObjectLayoutV1::Records::offset);
+  ASSERT_EQ(record.get<Record::Geometry>(8), 10.0f);
+  ASSERT_EQ(record.get<Record::Kinematics>(1), -1.5f);
+  ASSERT_EQ(record.get<Record::Confidence>(), 90);
+
+  encoder.encodeTelemetry(buffer, 42, 30.0f, "AB");
+  hfl::TelemetryViewV1 telemetry(buffer.view());
+  ASSERT_EQ(telemetry.get<hfl::TelemetryLayoutV1::FrameCounter>(), 42u);
+  ASSERT_EQ(telemetry.get<hfl::TelemetryLayoutV1::HeaterTemperature>(), -30.0f);
+  ASSERT_EQ(telemetry.get<hfl::TelemetryLayoutV1::SerialNumber>(25), 'A');
+}
+
+TEST(DecoderRegistryTestSuite, testResolveByModelAndVersion)
+{
+  typedef int (*Decoder)(int);
+  hfl::DecoderRegistry<Decoder> registry;
+  registry.add("hfl110dcu", "v1", [](int x) { return x + 1; });
+  registry.add("hfl110dcu", "v2", [](int x) { return x + 2; });
+
+  Decoder decoder = nullptr;
+  ASSERT_TRUE(registry.find("hfl110dcu", "v2", decoder));
+  ASSERT_EQ(decoder(1), 3);
+  ASSERT_FALSE(registry.find("hfl110dcu", "v3", decoder));
+  ASSERT_FALSE(registry.find("hfl110", "v1", decoder));
+  // Failed lookups leave the decoder untouched
+  ASSERT_EQ(decoder(1), 3);
+  ASSERT_EQ(registry.getVersions("hfl110dcu").size(), 2u);
+}
+
+TEST(RangeTableTestSuite, testRebuildWhileReading)
+{
+  hfl::RangeTable table;
+  ASSERT_EQ(table.getOffset(), 0.0f);
+  {
+    hfl::RangeTable::Reader range(table);
+    ASSERT_EQ(range.get().table[256], 1.0f);
+    ASSERT_TRUE(std::isnan(range.get().table[65535]));
+  }
+
+  // Rebuilds do not change a pinned table
+  hfl::RangeTable::Reader pinned(table);
+  table.setOffset(512.0f);
+  ASSERT_EQ(pinned.get().offset, 0.0f);
+  ASSERT_EQ(pinned.get().table[256], 1.0f);
+  {
+    hfl::RangeTable::Reader range(table);
+    ASSERT_EQ(range.get().offset, 512.0f);
+    ASSERT_EQ(range.get().table[256], 3.0f);
+    ASSERT_EQ(range.get().table[1000], hfl::RangeTable::convert(512.0f, 1000));
+  }
+}
+
+TEST(PointProjectorTestSuite, testProjectRowInterleavesReturns)
+{
+  const size_t columns = hfl::ROW_COLUMNS;
+  hfl::PointProjector projector(2, columns);
+  projector.setRay(1, 3, 0.0f, 0.6f, 0.8f);
+
+  std::vector<float> range_1(columns, 2.0f), range_2(columns, NAN);
+  std::vector<uint16_t> intensity_1(columns, 7), intensity_2(columns, 9);
+  std::vector<uint8_t> flag_planes(6 * columns, 0);
+  flag_planes[4 * columns + 3] = 255;
+  hfl::DecodedRow row;
+  row.range_1 = range_1.data();
+  row.range_2 = range_2.data();
+  row.intensity_1 = intensity_1.data();
+  row.intensity_2 = intensity_2.data();
+  hfl::DecodedFlags flags;
+  flags.crosstalk = &flag_planes[0 * columns];
+  flags.saturated = &flag_planes[1 * columns];
+  flags.superimposed = &flag_planes[2 * columns];
+  flags.crosstalk_2 = &flag_planes[3 * columns];
+  flags.saturated_2 = &flag_planes[4 * columns];
+  flags.superimposed_2 = &flag_planes[5 * columns];
+
+  std::vector<uint8_t> points(projector.getRowStep());
+  ASSERT_EQ(points.size(), columns * 2 * hfl::POINT_STEP);
+  projector.projectRow(1, row, flags, points.data());
+
+  // Both returns of column 3 follow each other
+  const uint8_t* first = &points[3 * 2 * hfl::POINT_STEP];
+  const uint8_t* second = first + hfl::POINT_STEP;
+  float xyzi[4];
+  memcpy(xyzi, first + hfl::POINT_X_OFFSET, sizeof(xyzi));
+  ASSERT_FLOAT_EQ(xyzi[0], 0.0f);
+  ASSERT_FLOAT_EQ(xyzi[1], 1.2f);
+  ASSERT_FLOAT_EQ(xyzi[2], 1.6f);
+  ASSERT_EQ(xyzi[3], 7.0f);
+  ASSERT_EQ(first[hfl::POINT_RETURN_OFFSET], 1);
+  ASSERT_EQ(first[hfl::POINT_SATURATED_OFFSET], 0);
+
+  memcpy(xyzi, second + hfl::POINT_X_OFFSET, sizeof(xyzi));
+  ASSERT_TRUE(std::isnan(xyzi[2]));
+  ASSERT_EQ(xyzi[3], 9.0f);
+  ASSERT_EQ(second[hfl::POINT_RETURN_OFFSET], 2);
+  ASSERT_EQ(second[hfl::POINT_SATURATED_OFFSET], 255);
+
+  // Pixels without a ray are no point
+  memcpy(xyzi, &points[hfl::POINT_X_OFFSET], sizeof(xyzi));
+  ASSERT_TRUE(std::isnan(xyzi[0]));
+}
+
+TEST(CalibrationMonitorTestSuite, testEpochAdvancesOnChange)
+{
+  hfl::SensorCalibration calibration;
+  hfl::PacketEncoder encoder(calibration);
+  hfl::FrameRowData row_data = {};
+  hfl::PacketBuffer packet;
+  encoder.encodeFrameRow(packet, 1, 0, 0, row_data);
+  hfl::FrameViewV1 frame(packet.data);
+  const uint8_t* block = frame.at<hfl::FrameLayoutV1::CalibrationParameters>();
+  const size_t size = hfl::FrameLayoutV1::CalibrationParameters::size;
+
+  hfl::CalibrationMonitor monitor;
+  ASSERT_EQ(monitor.getEpoch(), 0u);
+  ASSERT_TRUE(monitor.update(block, size));
+  ASSERT_EQ(monitor.getEpoch(), 1u);
+  ASSERT_EQ(monitor.getHash(), hfl::CalibrationMonitor::hash(block, size));
+
+  // Later rows and frames carry the same calibration
+  encoder.encodeFrameRow(packet, 2, 5, 1000, row_data);
+  ASSERT_FALSE(monitor.update(block, size));
+  ASSERT_EQ(monitor.getEpoch(), 1u);
+
+  // Status is not part of the parameters
+  hfl::FrameLayoutV1::CalibrationStatus::store(packet.data, 1);
+  ASSERT_FALSE(monitor.update(block, size));
+
+  calibration.fx += 1.0f;
+  hfl::PacketEncoder(calibration).encodeFrameRow(packet, 3, 0, 0, row_data);
+  ASSERT_TRUE(monitor.update(block, size));
+  ASSERT_EQ(monitor.getEpoch(), 2u);
+}
+
+TEST(MessagePoolTestSuite, testReleasedMessagesAreReused)
+{
+  hfl::MessagePool<std::vector<uint8_t>> pool(1, [](std::vector<uint8_t>& message) { message.resize(16); });
+  ASSERT_EQ(pool.getSize(), 1u);
+
+  std::shared_ptr<std::vector<uint8_t>> first = pool.acquire();
+  ASSERT_EQ(first->size(), 16u);
+  const uint8_t* data = first->data();
+  ASSERT_EQ(pool.getAvailable(), 0u);
+
+  // Pool exhausted, a new message is created and kept
+  std::shared_ptr<std::vector<uint8_t>> second = pool.acquire();
+  ASSERT_EQ(pool.getMisses(), 1u);
+  ASSERT_EQ(pool.getSize(), 2u);
+
+  // Released once the last holder lets go, buffer included
+  std::shared_ptr<std::vector<uint8_t>> holder = first;
+  first.reset();
+  ASSERT_EQ(pool.getAvailable(), 0u);
+  holder.reset();
+  ASSERT_EQ(pool.getAvailable(), 1u);
+  ASSERT_EQ(pool.acquire()->data(), data);
+  ASSERT_EQ(pool.getMisses(), 1u);
+}
+
+TEST(MessagePoolTestSuite, testMessagesOutlivePool)
+{
+  std::shared_ptr<std::vector<uint8_t>> message;
+  {
+    hfl::MessagePool<std::vector<uint8_t>> pool(2);
+    message = pool.acquire();
+  }
+  message->push_back(1);
+  message.reset();
+}
+
+TEST(BoundedQueueTestSuite, testOverflowPolicies)
+{
+  hfl::BoundedQueue<int> oldest(2, hfl::overflow_drop_oldest);
+  hfl::BoundedQueue<int> newest(2, hfl::overflow_drop_newest);
+  for (int i = 1; i <= 3; i += 1)
+  {
+    ASSERT_EQ(oldest.push(i), i < 3);
+    ASSERT_EQ(newest.push(i), i < 3);
+  }
+  ASSERT_EQ(oldest.getDropCount(), 1u);
+  ASSERT_EQ(newest.getDropCount(), 1u);
+  ASSERT_EQ(oldest.getMaxDepth(), 2u);
+
+  int item = 0;
+  ASSERT_TRUE(oldest.pop(item));
+  ASSERT_EQ(item, 2);
+  ASSERT_TRUE(newest.pop(item));
+  ASSERT_EQ(item, 1);
+  ASSERT_TRUE(newest.pop(item));
+  ASSERT_EQ(item, 2);
+}
+
+TEST(BoundedQueueTestSuite, testCloseDrainsConsumer)
+{
+  hfl::BoundedQueue<std::unique_ptr<int>> queue(4, hfl::overflow_drop_oldest);
+  int sum = 0;
+  std::thread consumer([&queue, &sum]() {
+    std::unique_ptr<int> item;
+    while (queue.pop(item))
+    {
+      sum += *item;
+    }
+  });
+  for (int i = 1; i <= 3; i += 1)
+  {
+    queue.push(std::unique_ptr<int>(new int(i)));
+  }
+  queue.close();
+  consumer.join();
+  ASSERT_EQ(sum, 6);
+  ASSERT_EQ(queue.depth(), 0u);
+}
+
+TEST(PackedFrameTestSuite, testRowsLandInTheirPlanes)
+{
+  const size_t columns = hfl::ROW_COLUMNS;
+  hfl::PackedFrameLayout layout(2, columns);
+  ASSERT_EQ(layout.getOffset(hfl::packed_range), 0u);
+  ASSERT_EQ(layout.getOffset(hfl::packed_range2), 2 * columns * sizeof(float));
+  ASSERT_EQ(layout.getOffset(hfl::packed_flags), 2 * columns * (2 * sizeof(float) + 2 * sizeof(uint16_t)));
+  ASSERT_EQ(layout.getSize(), layout.getOffset(hfl::packed_flags) + 2 * columns);
+
+  hfl::FrameRowData row = {};
+  std::vector<uint8_t> flags(columns);
+  for (size_t col = 0; col < hfl::ENCODER_COLUMNS; col += 1)
+  {
+    row.range[col][0] = uint16_t(col * 64);
+    row.range[col][1] = uint16_t(65535);
+    row.intensity[col][0] = uint16_t(col);
+    row.intensity[col][1] = uint16_t(col + 1000);
+    row.flags[col] = uint8_t(col);
+    flags[col] = uint8_t(col);
+  }
+  hfl::PacketBuffer packet;
+  hfl::PacketEncoder().encodeFrameRow(packet, 0, 0, 0, row);
+
+  // Decode straight into the second row, the first one is cleared
+  std::vector<uint8_t> data(layout.getSize());
+  hfl::RangeTable range_table;
+  hfl::RangeTable::Reader range(range_table);
+  hfl::RowDecoder().decode(&packet.data[hfl::FRAME_DATA_OFFSET], range.get(), layout.getRangeRow(data.data(), 1));
+  layout.copyFlags(data.data(), 1, flags.data());
+  layout.clearRow(data.data(), 0);
+
+  const float* range_1 = layout.getRow<float>(&data[0], hfl::packed_range, 1);
+  const float* range_2 = layout.getRow<float>(&data[0], hfl::packed_range2, 1);
+  const uint16_t* intensity_2 = layout.getRow<uint16_t>(&data[0], hfl::packed_intensity2, 1);
+  const uint8_t* packed_flags = layout.getRow<uint8_t>(&data[0], hfl::packed_flags, 1);
+  for (size_t col = 0; col < columns; col += 1)
+  {
+    ASSERT_EQ(range_1[col], col / 4.0f);
+    ASSERT_TRUE(std::isnan(range_2[col]));
+    ASSERT_EQ(intensity_2[col], col + 1000);
+    ASSERT_EQ(packed_flags[col], col);
+    ASSERT_TRUE(std::isnan(layout.getRow<float>(&data[0], hfl::packed_range, 0)[col]));
+    ASSERT_EQ(layout.getRow<uint16_t>(&data[0], hfl::packed_intensity, 0)[col], 0);
+    ASSERT_EQ(layout.getRow<uint8_t>(&data[0], hfl::packed_flags, 0)[col], 0);
+  }
+
+  // Decoded elsewhere and copied in
+  std::vector<uint8_t> copy(layout.getSize());
+  layout.copyRanges(copy.data(), 1, layout.getRangeRow(data.data(), 1));
+  ASSERT_EQ(memcmp(layout.getRow<uint8_t>(&copy[0], hfl::packed_range, 1),
+                   layout.getRow<uint8_t>(&data[0], hfl::packed_range, 1),
+                   layout.getStep(hfl::packed_range)), 0);
+  ASSERT_EQ(layout.getRow<uint16_t>(&copy[0], hfl::packed_intensity2, 1)[5], 1005);
+}
+
+TEST(DepthCodecTestSuite, testRoundTripIsBitExact)
+{
+  const uint32_t rows = 32, columns = 128;
+  std::vector<float> ranges(rows * columns);
+  std::vector<uint16_t> words(rows * columns);
+  for (size_t i = 0; i < ranges.size(); i += 1)
+  {
+    // Ramps with noise, a no return block and ranges off the fixed point grid
+    uint16_t word = uint16_t(2000 + (i % columns) * 40 + (i * 7919) % 13);
+    ranges[i] = hfl::RangeTable::convert(256.0f, word);
+    words[i] = uint16_t(word * 3);
+  }
+  for (size_t i = 600; i < 900; i += 1)
+  {
+    ranges[i] = hfl::RangeTable::convert(0.0f, 65535);
+  }
+  ranges[5] = hfl::RangeTable::convert(0.3f, 1000);
+  ranges[6] = -0.0f;
+  ranges[7] = std::numeric_limits<float>::infinity();
+  words[9] = 65535;
+
+  std::vector<uint8_t> compressed, image;
+  hfl::depth_codec_format format;
+  uint32_t decoded_rows, decoded_columns;
+  hfl::DepthCodec::encode(ranges.data(), rows, columns, compressed);
+  ASSERT_LT(compressed.size(), ranges.size() * sizeof(float) / 2);
+  ASSERT_TRUE(hfl::DepthCodec::decode(compressed.data(), compressed.size(), format, decoded_rows,
+                                      decoded_columns, image));
+  ASSERT_EQ(format, hfl::depth_codec_range);
+  ASSERT_EQ(decoded_rows, rows);
+  ASSERT_EQ(decoded_columns, columns);
+  ASSERT_EQ(image.size(), ranges.size() * sizeof(float));
+  ASSERT_EQ(memcmp(image.data(), ranges.data(), image.size()), 0);
+
+  hfl::DepthCodec::encode(words.data(), rows, columns, compressed);
+  ASSERT_TRUE(hfl::DepthCodec::decode(compressed.data(), compressed.size(), format, decoded_rows,
+                                      decoded_columns, image));
+  ASSERT_EQ(format, hfl::depth_codec_word);
+  ASSERT_EQ(image.size(), words.size() * sizeof(uint16_t));
+  ASSERT_EQ(memcmp(image.data(), words.data(), image.size()), 0);
+
+  // Truncated and trailing data are rejected
+  ASSERT_FALSE(hfl::DepthCodec::decode(compressed.data(), compressed.size() - 1, format, decoded_rows,
+                                       decoded_columns, image));
+  compressed.push_back(0);
+  ASSERT_FALSE(hfl::DepthCodec::decode(compressed.data(), compressed.size(), format, decoded_rows,
+                                       decoded_columns, image));
+
+  // Headers claiming huge images are rejected before allocating
+  std::vector<uint8_t> forged(compressed.begin(), compressed.begin() + hfl::DEPTH_CODEC_HEADER_SIZE);
+  const uint8_t huge[8] = { 1, 0, 0, 0, 0x00, 0x28, 0x6b, 0xee };
+  memcpy(&forged[6], huge, sizeof(huge));
+  forged.push_back(uint8_t(0xfc));
+  forged.push_back(0xff);
+  forged.push_back(0xff);
+  forged.push_back(0xff);
+  forged.push_back(0x0f);
+  ASSERT_FALSE(hfl::DepthCodec::decode(forged.data(), forged.size(), format, decoded_rows,
+                                       decoded_columns, image));
+}